@@ -30,41 +30,38 @@ void reboot(OutputInterface* terminal) {
   resetFunc();
 }
 
-// Slow Count - Example Command added to the Terminal, Slowing count up from the parameter given in the command
-void slowCount(OutputInterface* terminal) {
-  bool passed = false;
-  String value = terminal->readParameter(); // Read the Parameter from the command line
-  if (value != NULL) {
-    int count = value.toInt();
-    if ((count > 0) && (count <= 60)) {
-      passed = true;
-      for (int i = 0; i < count; i++) {
-#ifdef TERMINAL_LOGGING
-        terminal->print(INFO, String(i + 1) + " "); // Output to the terminal
-#else
-        terminal->print(String(i + 1) + " "); // Output to the terminal
-#endif
-        delay(1000);
-      }
-    } else {
+// Slow Count - Example Command added to the Terminal, Slowly counts up to the parameter given in the command.
+// The count runs as a task: it is resumed from loop once a second, so the rest of loop keeps
+// running in between. Ctrl-C stops it.
+TASK_STATUS slowCountTask(OutputInterface* terminal, TerminalTask* task) {
+  task->state++;
 #ifdef TERMINAL_LOGGING
-      terminal->println(ERROR,
-                        "Parameter " + String(count) + " is not between 1 and 60!"); // Error Output to the Terminal
+  terminal->print(INFO, String(task->state) + " "); // Output to the terminal
 #else
-      terminal->println("Parameter " + String(count) + " is not between 1 and 60!"); // Error Output to the Terminal
+  terminal->print(String(task->state) + " "); // Output to the terminal
 #endif
-    }
-  } else
-    terminal->invalidParameter();
+  if ((long) task->state < task->value) {
+    task->sleep(1000); // Resume in one second
+    return TASK_RUNNING;
+  }
   terminal->println();
 #ifdef TERMINAL_LOGGING
-  terminal->println((passed) ? PASSED : FAILED,
-                    "Slow Count Complete"); // Indication to the Terminal that the command has passed or failed.
+  terminal->println(PASSED, "Slow Count Complete"); // Indication to the Terminal that the command has passed.
 #else
-  terminal->println(String((passed) ? "PASSED" : "FAILED") +
-                    " - Slow Count Complete"); // Indication to the Terminal that the command has passed or failed.
+  terminal->println("PASSED - Slow Count Complete"); // Indication to the Terminal that the command has passed.
 #endif
   terminal->prompt(); // Prompt the user for the next command
+  return TASK_DONE;
+}
+
+// The count, 1 to 60 seconds, is checked by readParameters
+const char secondsName[] PROGMEM = "seconds";
+const ParamSpec slowCountParameters[] PROGMEM = {paramInt(secondsName, 1, 60)};
+
+void slowCount(OutputInterface* terminal) {
+  ParamValue values[1];
+  if (!terminal->readParameters(slowCountParameters, 1, values)) return; // Reports the bad parameter and prompts
+  terminal->startTask(slowCountTask, values[0].integer); // The prompt is printed by the task when it is done
 }
 
 void setup() {
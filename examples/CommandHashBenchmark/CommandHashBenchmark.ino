@@ -0,0 +1,109 @@
+/*
+  CommandHashBenchmark.ino - Times the three ways a command name is looked up
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+
+  Type bench to compare the original findCmd (a String compared with every name), addCmd (binary
+  search over RAM names), a flash table (binary search in place) and the same flash table with its
+  compile time perfect hash.
+*/
+#include <Terminal.h>
+
+Terminal terminal(&Serial);
+
+void nothing(OutputInterface* terminal) { terminal->prompt(); }
+
+// The names and the table must be constexpr for TERMINAL_CMD_HASH, and PROGMEM on AVR
+constexpr char adcName[] PROGMEM = "adc";
+constexpr char baudName[] PROGMEM = "baud";
+constexpr char dumpName[] PROGMEM = "dump";
+constexpr char flashName[] PROGMEM = "flash";
+constexpr char gpioName[] PROGMEM = "gpio";
+constexpr char i2cName[] PROGMEM = "i2c";
+constexpr char ledName[] PROGMEM = "led";
+constexpr char memName[] PROGMEM = "mem";
+constexpr char pwmName[] PROGMEM = "pwm";
+constexpr char rtcName[] PROGMEM = "rtc";
+constexpr char scanName[] PROGMEM = "scan";
+constexpr char spiName[] PROGMEM = "spi";
+constexpr char tempName[] PROGMEM = "temp";
+constexpr char uartName[] PROGMEM = "uart";
+constexpr char uptimeName[] PROGMEM = "uptime";
+constexpr char wifiName[] PROGMEM = "wifi";
+constexpr char empty[] PROGMEM = "";
+
+constexpr CmdEntry commands[] PROGMEM = {
+  {adcName, empty, empty, nothing},  {baudName, empty, empty, nothing}, {dumpName, empty, empty, nothing},
+  {flashName, empty, empty, nothing}, {gpioName, empty, empty, nothing}, {i2cName, empty, empty, nothing},
+  {ledName, empty, empty, nothing},  {memName, empty, empty, nothing},  {pwmName, empty, empty, nothing},
+  {rtcName, empty, empty, nothing},  {scanName, empty, empty, nothing}, {spiName, empty, empty, nothing},
+  {tempName, empty, empty, nothing}, {uartName, empty, empty, nothing}, {uptimeName, empty, empty, nothing},
+  {wifiName, empty, empty, nothing},
+};
+const int commandCount = sizeof(commands) / sizeof(commands[0]);
+
+// Names the benchmark looks up, every command and a few misses
+const char* const lookups[] = {"adc", "baud",  "dump", "flash", "gpio", "i2c",    "led",  "mem",  "pwm",
+                               "rtc", "scan",  "spi",  "temp",  "uart", "uptime", "wifi", "wif", "zzz"};
+const int lookupCount = sizeof(lookups) / sizeof(lookups[0]);
+const int ROUNDS = 100;
+
+TerminalCommand flashCommands;
+
+// The original lookup, kept here as the baseline: the name is made a String and compared with
+// every command, the last match wins
+String linearNames[commandCount];
+int linearFindCmd(String command) {
+  int cmdIndex = -1;
+  for (int i = 0; i < commandCount; i++) {
+    if (command == linearNames[i]) cmdIndex = i;
+  }
+  return cmdIndex;
+}
+
+unsigned long timeLinear() {
+  volatile int found = 0;
+  unsigned long start = micros();
+  for (int round = 0; round < ROUNDS; round++)
+    for (int i = 0; i < lookupCount; i++) found += linearFindCmd(lookups[i]);
+  return micros() - start;
+}
+
+unsigned long timeLookups(TerminalCommand* commandList) {
+  volatile int found = 0;
+  unsigned long start = micros();
+  for (int round = 0; round < ROUNDS; round++)
+    for (int i = 0; i < lookupCount; i++) found += commandList->findCmd(lookups[i]);
+  return micros() - start;
+}
+
+void report(OutputInterface* terminal, const char* name, unsigned long elapsed) {
+  terminal->println(String(name) + ": " + String(elapsed) + " us, " +
+                    String((float) elapsed * 1000 / (ROUNDS * lookupCount)) + " ns per lookup");
+}
+
+void bench(OutputInterface* terminal) {
+  report(terminal, "linear    ", timeLinear());
+  report(terminal, "addCmd    ", timeLookups(TERM_CMD));
+  flashCommands.setStaticTable(commands, commandCount);
+  report(terminal, "table     ", timeLookups(&flashCommands));
+  flashCommands.setStaticTable(commands, commandCount, TERMINAL_CMD_HASH(commands));
+  report(terminal, "table hash", timeLookups(&flashCommands));
+  terminal->prompt();
+}
+
+void setup() {
+  Serial.begin(115200);
+  terminal.setup();
+  // The same names again in RAM, to compare against
+  for (int i = 0; i < commandCount; i++) {
+    const char* name = (const char*) pgm_read_ptr(&commands[i].command);
+    linearNames[i] = String(reinterpret_cast<const __FlashStringHelper*>(name));
+    TERM_CMD->addCmd(linearNames[i], "", "", nothing);
+  }
+  TERM_CMD->addCmd("bench", "", "Times command lookups", bench);
+  terminal.prompt();
+}
+
+void loop() {
+  terminal.loop();
+}
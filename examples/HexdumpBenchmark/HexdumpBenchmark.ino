@@ -0,0 +1,49 @@
+/*
+  HexdumpBenchmark.ino - Times the hexdump engine, alone and through the terminal
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+
+  Type bench to encode ROUNDS passes over a buffer into rows, which is the cost of the dump
+  itself, then dump the buffer to the terminal with the ASCII gutter and repeated rows squeezed.
+*/
+#include <Terminal.h>
+
+Terminal terminal(&Serial);
+
+const unsigned int BUFFER_SIZE = 1024;
+const int ROUNDS = 16;
+unsigned char buffer[BUFFER_SIZE];
+
+void bench(OutputInterface* terminal) {
+  char row[HEXDUMP_ROW_SIZE];
+  volatile unsigned long characters = 0;
+  unsigned long start = micros();
+  for (int round = 0; round < ROUNDS; round++) {
+    TerminalUtility::HexDump dump(buffer, BUFFER_SIZE, HEXDUMP_ASCII);
+    unsigned int rowLength;
+    while ((rowLength = dump.next(row)) > 0) characters += rowLength;
+  }
+  unsigned long elapsed = micros() - start;
+  unsigned long bytes = (unsigned long) BUFFER_SIZE * ROUNDS;
+  terminal->println("encode: " + String(bytes) + " bytes in " + String(elapsed) + " us, " +
+                    String((float) bytes * 1000 / elapsed) + " KB/s");
+
+  start = micros();
+  terminal->hexdump(buffer, BUFFER_SIZE, HEXDUMP_ASCII | HEXDUMP_SQUEEZE);
+  terminal->flush();
+  elapsed = micros() - start;
+  terminal->println("print: " + String(BUFFER_SIZE) + " bytes in " + String(elapsed) + " us");
+  terminal->prompt();
+}
+
+void setup() {
+  Serial.begin(115200);
+  // Text in the first half, a repeated pattern in the second to show squeezing
+  for (unsigned int i = 0; i < BUFFER_SIZE; i++) buffer[i] = (i < BUFFER_SIZE / 2) ? (' ' + i % 95) : 0xA5;
+  terminal.setup();
+  TERM_CMD->addCmd("bench", "", "Times hexdump", bench);
+  terminal.prompt();
+}
+
+void loop() {
+  terminal.loop();
+}
@@ -26,28 +26,30 @@ void uploadPico(OutputInterface* terminal) {
   rp2040.rebootToBootloader();
 }
 
-// Slow Count - Example Command added to the Terminal, Slowing count up from the parameter given in the command
-void slowCount(OutputInterface* terminal) {
-  bool passed = false;
-  String value = terminal->readParameter(); // Read the Parameter from the command line
-  if (value != NULL) {
-    int count = value.toInt();
-    if ((count > 0) && (count <= 60)) {
-      passed = true;
-      for (int i = 0; i < count; i++) {
-        terminal->print(INFO, String(i + 1) + " "); // Output to the terminal
-        delay(1000);
-      }
-    } else {
-      terminal->println(ERROR,
-                        "Parameter " + String(count) + " is not between 1 and 60!"); // Error Output to the Terminal
-    }
-  } else
-    terminal->invalidParameter();
+// Slow Count - Example Command added to the Terminal, Slowly counts up to the parameter given in the command.
+// The count runs as a task: it is resumed from loop once a second, so the other terminals and the rest
+// of loop keep running in between. Ctrl-C stops it.
+TASK_STATUS slowCountTask(OutputInterface* terminal, TerminalTask* task) {
+  task->state++;
+  terminal->print(INFO, String(task->state) + " "); // Output to the terminal
+  if ((long) task->state < task->value) {
+    task->sleep(1000); // Resume in one second
+    return TASK_RUNNING;
+  }
   terminal->println();
-  terminal->println((passed) ? PASSED : FAILED,
-                    "Slow Count Complete"); // Indication to the Terminal that the command has passed or failed.
-  terminal->prompt();                       // Prompt the user for the next command
+  terminal->println(PASSED, "Slow Count Complete"); // Indication to the Terminal that the command has passed.
+  terminal->prompt();                               // Prompt the user for the next command
+  return TASK_DONE;
+}
+
+// The count, 1 to 60 seconds, is checked by readParameters
+const char secondsName[] PROGMEM = "seconds";
+const ParamSpec slowCountParameters[] PROGMEM = {paramInt(secondsName, 1, 60)};
+
+void slowCount(OutputInterface* terminal) {
+  ParamValue values[1];
+  if (!terminal->readParameters(slowCountParameters, 1, values)) return; // Reports the bad parameter and prompts
+  terminal->startTask(slowCountTask, values[0].integer); // The prompt is printed by the task when it is done
 }
 
 // Custom Banner - Added to the start of the Terminal and Help Command
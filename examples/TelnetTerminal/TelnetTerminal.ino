@@ -6,6 +6,7 @@
 
 /* This program will open a serial terminal on the usb port of the PicoW */
 /* It will open a socket for the telnet program to access on the wifi.*/
+/* Up to TERMINAL_SERVER_SESSIONS telnet clients can be connected at the same time.*/
 
 #include <Terminal.h>
 #include <WiFi.h>
@@ -22,9 +23,10 @@ const char* password = STAPSK;
 int port = 23;
 
 WiFiServer server(port);
-WiFiClient client;
-Terminal telnet(&client);
-bool isTelnetConnected = false;
+WiFiClient clients[TERMINAL_SERVER_SESSIONS];
+// Telnet sessions, all sharing the commands added to TERM_CMD
+TerminalServer telnet;
+TerminalSettings telnetSettings; // Settings given to every new telnet session
 
 // Serial Port Terminal Initialized with the Serial Stream
 Terminal terminal(&Serial);
@@ -70,10 +72,9 @@ void uploadPico(OutputInterface* terminal) {
 
 // Exits the Telnet Session
 void exitTelnet(OutputInterface* terminal) {
-  if (terminal == &telnet) {
+  if (telnet.findSession(terminal) >= 0) {
     terminal->println(WARNING, "Closing Telnet Session....");
-    delay(100);
-    client.stop();
+    telnet.detach(terminal);
   } else {
     terminal->println(ERROR, "Not Supported on this terminal.");
     terminal->prompt();
@@ -120,28 +121,30 @@ void wifiScan(OutputInterface* terminal) {
   terminal->prompt();
 }
 
-// Slow Count - Example Command added to the Terminal, Slowing count up from the parameter given in the command
-void slowCount(OutputInterface* terminal) {
-  bool passed = false;
-  String value = terminal->readParameter(); // Read the Parameter from the command line
-  if (value != NULL) {
-    int count = value.toInt();
-    if ((count > 0) && (count <= 60)) {
-      passed = true;
-      for (int i = 0; i < count; i++) {
-        terminal->print(INFO, String(i + 1) + " "); // Output to the terminal
-        delay(1000);
-      }
-    } else {
-      terminal->println(ERROR,
-                        "Parameter " + String(count) + " is not between 1 and 60!"); // Error Output to the Terminal
-    }
-  } else
-    terminal->invalidParameter();
+// Slow Count - Example Command added to the Terminal, Slowly counts up to the parameter given in the command.
+// The count runs as a task: it is resumed from loop once a second, so the other terminals and the rest
+// of loop keep running in between. Ctrl-C stops it.
+TASK_STATUS slowCountTask(OutputInterface* terminal, TerminalTask* task) {
+  task->state++;
+  terminal->print(INFO, String(task->state) + " "); // Output to the terminal
+  if ((long) task->state < task->value) {
+    task->sleep(1000); // Resume in one second
+    return TASK_RUNNING;
+  }
   terminal->println();
-  terminal->println((passed) ? PASSED : FAILED,
-                    "Slow Count Complete"); // Indication to the Terminal that the command has passed or failed.
-  terminal->prompt();                       // Prompt the user for the next command
+  terminal->println(PASSED, "Slow Count Complete"); // Indication to the Terminal that the command has passed.
+  terminal->prompt();                               // Prompt the user for the next command
+  return TASK_DONE;
+}
+
+// The count, 1 to 60 seconds, is checked by readParameters
+const char secondsName[] PROGMEM = "seconds";
+const ParamSpec slowCountParameters[] PROGMEM = {paramInt(secondsName, 1, 60)};
+
+void slowCount(OutputInterface* terminal) {
+  ParamValue values[1];
+  if (!terminal->readParameters(slowCountParameters, 1, values)) return; // Reports the bad parameter and prompts
+  terminal->startTask(slowCountTask, values[0].integer); // The prompt is printed by the task when it is done
 }
 /******* End Terminal Commands ***************/
 
@@ -191,12 +194,34 @@ void setupSerialPort() {
 }
 
 void setupTelnet() {
-  // Setup the Telnet Terminal
-  telnet.setup();
-  telnet.setColor(true);
-  telnet.setPrompt("telnet://>");
-  telnet.setBannerFunction(banner);
-  telnet.setEcho(true);
+  // Settings given to each Telnet session when a client connects
+  telnetSettings.color = true;
+  telnetSettings.promptString = "telnet://>";
+  telnetSettings.bannerFunction = banner;
+  telnetSettings.echo = true;
+  telnet.configure(telnetSettings);
+  // A congested client loses output, marked "[ output dropped ]", instead of stalling the serial
+  // console and the other sessions. BACKPRESSURE_DISCONNECT closes the client instead.
+  telnet.setBackpressure(BACKPRESSURE_DROP);
+}
+
+// Hands a new client to a free session, or turns it away when all sessions are in use.
+void acceptTelnet() {
+  WiFiClient incoming = server.accept();
+  if (!incoming) return;
+  for (int i = 0; i < TERMINAL_SERVER_SESSIONS; i++) {
+    if (!clients[i].connected()) {
+      clients[i] = incoming;
+      Terminal* session = telnet.attach(&clients[i]);
+      if (session == nullptr) break;
+      session->println(INFO, "Starting Telnet Session.");
+      session->banner();
+      session->prompt();
+      return;
+    }
+  }
+  incoming.println("All sessions are in use.");
+  incoming.stop();
 }
 
 void setup() {
@@ -210,6 +235,7 @@ void setup() {
   WiFi.begin(ssid, password);
   while (WiFi.status() != WL_CONNECTED) {
     terminal.print(INFO, ".");
+    terminal.flush();
     delay(100);
   }
   server.begin();
@@ -237,25 +263,10 @@ void setup() {
 }
 
 void loop() {
-  // Process the telnet session
-  if (!isTelnetConnected) {
-    client = server.accept();
-    if (client.connected()) {
-      isTelnetConnected = true;
-      telnet.setStream(&client);
-      telnet.println(INFO, "Starting Telnet Session.");
-      telnet.banner();
-      telnet.prompt();
-      client.flush();
-    }
-  } else {
-    if (client.connected()) {
-      telnet.loop();
-      client.flush();
-    } else {
-      isTelnetConnected = false;
-    }
-  }
+  // Process every telnet session, closed sessions are cleaned up here before their client
+  // objects are handed to new connections
+  telnet.poll();
+  acceptTelnet();
 
   terminal.loop();
   delay(10);
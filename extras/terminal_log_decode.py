@@ -0,0 +1,197 @@
+#!/usr/bin/env python3
+"""
+  terminal_log_decode.py - Decodes the tokenized Debug records of the Terminal library
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+
+  Build the sketch with TERMINAL_DEBUG_TOKENIZED defined and register a binary sink:
+    Debug::instance().registerBinaryOutput(&Serial1);
+  then decode what that sink sends with the ELF file of the same build:
+    python3 terminal_log_decode.py firmware.elf capture.bin
+    python3 terminal_log_decode.py firmware.elf --port /dev/ttyUSB0 --baud 115200   (needs pyserial)
+  Bytes that are not part of a record are passed through unchanged.
+  For AVR builds add --data-offset 0x800000, format strings live in RAM there.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+FRAME_START = 0x1E
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+CONVERSION = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|j|z|t|L)?([diouxXeEfFgGcsp%])")
+
+
+class FormatTable:
+    """Reads the format strings out of the loaded sections of an ELF file."""
+
+    def __init__(self, path, data_offset=0):
+        with open(path, "rb") as f:
+            self.image = f.read()
+        self.data_offset = data_offset
+        self.sections = []
+        self.cache = {}
+        self._read_sections()
+
+    def _read_sections(self):
+        image = self.image
+        if image[:4] != b"\x7fELF":
+            raise ValueError("not an ELF file")
+        is64 = image[4] == 2
+        endian = "<" if image[5] == 1 else ">"
+        if is64:
+            shoff, = struct.unpack_from(endian + "Q", image, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + "HH", image, 0x3A)
+        else:
+            shoff, = struct.unpack_from(endian + "I", image, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + "HH", image, 0x2E)
+        for i in range(shnum):
+            base = shoff + i * shentsize
+            if is64:
+                _, kind, flags, addr, offset, size = struct.unpack_from(endian + "IIQQQQ", image, base)
+            else:
+                _, kind, flags, addr, offset, size = struct.unpack_from(endian + "IIIIII", image, base)
+            if (flags & SHF_ALLOC) and kind != SHT_NOBITS and size > 0:
+                self.sections.append((addr, offset, size))
+
+    def lookup(self, address):
+        if address not in self.cache:
+            self.cache[address] = self._string_at(address + self.data_offset)
+        return self.cache[address]
+
+    def _string_at(self, address):
+        for addr, offset, size in self.sections:
+            if addr <= address < addr + size:
+                start = offset + (address - addr)
+                end = self.image.find(b"\0", start, offset + size)
+                if end >= 0:
+                    return self.image[start:end].decode("utf-8", "replace")
+        return None
+
+
+def read_arguments(payload):
+    """Splits the tagged argument bytes of a record into Python values."""
+    values = []
+    i = 0
+    while i < len(payload):
+        tag = chr(payload[i])
+        i += 1
+        if tag == "i":
+            values.append(struct.unpack_from("<i", payload, i)[0]); i += 4
+        elif tag in "up":
+            values.append(struct.unpack_from("<I", payload, i)[0]); i += 4
+        elif tag == "q":
+            values.append(struct.unpack_from("<q", payload, i)[0]); i += 8
+        elif tag == "Q":
+            values.append(struct.unpack_from("<Q", payload, i)[0]); i += 8
+        elif tag == "f":
+            values.append(struct.unpack_from("<f", payload, i)[0]); i += 4
+        elif tag == "d":
+            values.append(struct.unpack_from("<d", payload, i)[0]); i += 8
+        elif tag == "c":
+            values.append(chr(payload[i])); i += 1
+        elif tag == "s":
+            length = payload[i]
+            values.append(payload[i + 1:i + 1 + length].decode("utf-8", "replace")); i += 1 + length
+        else:
+            raise ValueError("unknown argument tag %r" % tag)
+    return values
+
+
+def render(fmt, values):
+    """Applies a C printf format to the decoded arguments."""
+    values = list(values)
+    out = []
+    position = 0
+    for match in CONVERSION.finditer(fmt):
+        out.append(fmt[position:match.start()])
+        position = match.end()
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == "%":
+            out.append("%")
+            continue
+        if width == "*":
+            width = str(values.pop(0)) if values else ""
+        if precision == "*":
+            precision = str(values.pop(0)) if values else ""
+        spec = "%" + flags + (width or "") + ("." + precision if precision else "")
+        value = values.pop(0) if values else "<missing>"
+        if conversion == "p":
+            out.append((spec + "s") % ("0x%x" % value))
+        elif conversion == "c":
+            out.append((spec + "c") % (value if isinstance(value, str) else chr(value & 0xFF)))
+        elif conversion == "s":
+            out.append((spec + "s") % value)
+        elif conversion in "diu":
+            out.append((spec + "d") % value)
+        else:
+            out.append((spec + conversion) % value)
+    out.append(fmt[position:])
+    return "".join(out)
+
+
+def decode(table, read, write):
+    """Reads bytes with read(n), writes decoded text and passthrough bytes with write(str)."""
+    pending = bytearray()
+    while True:
+        chunk = read(256)
+        if not chunk:
+            break
+        pending += chunk
+        while pending:
+            start = pending.find(FRAME_START)
+            if start < 0:
+                write(pending.decode("utf-8", "replace"))
+                pending.clear()
+                break
+            if start > 0:
+                write(pending[:start].decode("utf-8", "replace"))
+                del pending[:start]
+            if len(pending) < 2 or len(pending) < 2 + pending[1]:
+                break
+            payload = bytes(pending[2:2 + pending[1]])
+            del pending[:2 + len(payload)]
+            if len(payload) < 4:
+                continue
+            address, = struct.unpack_from("<I", payload, 0)
+            fmt = table.lookup(address)
+            try:
+                values = read_arguments(payload[4:])
+                text = render(fmt, values) if fmt is not None else "<unknown format 0x%08x> %r" % (address, values)
+            except (ValueError, struct.error, TypeError, IndexError) as error:
+                text = "<bad record 0x%08x: %s>" % (address, error)
+            write(text)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode tokenized Terminal Debug records.")
+    parser.add_argument("elf", help="ELF file of the running firmware")
+    parser.add_argument("input", nargs="?", help="captured binary stream, stdin when omitted")
+    parser.add_argument("--port", help="read from a serial port instead (needs pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--data-offset", type=lambda x: int(x, 0), default=0,
+                        help="added to each format address, 0x800000 for AVR")
+    args = parser.parse_args()
+
+    table = FormatTable(args.elf, args.data_offset)
+    write = lambda text: (sys.stdout.write(text), sys.stdout.flush())
+    if args.port:
+        import serial
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            def read_port(n):
+                while True:  # A timeout returns nothing, keep waiting for the next bytes
+                    data = port.read(n)
+                    if data:
+                        return data
+            decode(table, read_port, write)
+    elif args.input:
+        with open(args.input, "rb") as f:
+            decode(table, f.read, write)
+    else:
+        decode(table, sys.stdin.buffer.read, write)
+
+
+if __name__ == "__main__":
+    main()
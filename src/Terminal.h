@@ -7,9 +7,11 @@
 #ifndef __TERMINAL
 #define __TERMINAL
 
+#include "cmdhash.h"
 #include "stdtermcmd.h"
 #include "terminal_debug.h"
 #include "terminalclass.h"
+#include "terminalserver.h"
 
 #include <Arduino.h>
 
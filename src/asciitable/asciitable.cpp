@@ -1,72 +1,206 @@
 #include "asciitable.h"
 
+#include "../utility/fieldEscape.h"
+
 namespace ASCIITable {
 
-static String tab(int lengthPrinted, int totalLength) {
-  String spaces = "";
-  for (int i = lengthPrinted; i < totalLength; i++) spaces += " ";
-  return spaces;
+#define MAX_CELL_WIDTH 80
+TableWriter::TableWriter(OutputInterface* __terminal, TableColumn* __columns, unsigned int __count) {
+  terminal = __terminal;
+  columns = __columns;
+  count = __count;
 }
 
-AsciiTable::AsciiTable(OutputInterface* __terminal) {
-  terminal = __terminal;
-  for (int i = 0; i < MAX_TABLE_COLUMNS; i++) {
-    columnColor[i] = Normal;
-    columnWidth[i] = 0;
-    columnHeader[i] = "";
+void TableWriter::fit(unsigned int column, const char* text) {
+  size_t width = ((text == nullptr) ? 0 : strnlen(text, MAX_CELL_WIDTH - 2)) + 2;
+  if (width > columns[column].width) columns[column].width = width;
+}
+
+void TableWriter::fitRow(const char* const* cells) {
+  for (unsigned int i = 0; i < count; i++) fit(i, cells[i]);
+}
+
+void TableWriter::fitRow(const String* cells) {
+  for (unsigned int i = 0; i < count; i++) fit(i, cells[i].c_str());
+}
+
+void TableWriter::flushRun() {
+  if (runLength > 0) terminal->print(runColor, run, runLength);
+  runLength = 0;
+}
+
+void TableWriter::append(COLOR color, const char* data, size_t length) {
+  if (color != runColor) flushRun();
+  runColor = color;
+  while (length > 0) {
+    if (runLength == sizeof(run)) flushRun();
+    size_t part = sizeof(run) - runLength;
+    if (part > length) part = length;
+    memcpy(&run[runLength], data, part);
+    runLength += part;
+    data += part;
+    length -= part;
   }
-  numberOfColumns = 0;
 }
 
-void AsciiTable::addColumn(COLOR color, String header, unsigned long width) {
-  if (numberOfColumns < MAX_TABLE_COLUMNS) {
-    columnColor[numberOfColumns] = color;
-    columnWidth[numberOfColumns] = width;
-    columnHeader[numberOfColumns] = header;
-    numberOfColumns++;
+void TableWriter::appendFill(COLOR color, char fill, size_t length) {
+  if (color != runColor) flushRun();
+  runColor = color;
+  while (length > 0) {
+    if (runLength == sizeof(run)) flushRun();
+    size_t part = sizeof(run) - runLength;
+    if (part > length) part = length;
+    memset(&run[runLength], fill, part);
+    runLength += part;
+    length -= part;
   }
 }
 
-static const String dashes = "-------------------------------------------------------------------------------";
+void TableWriter::appendEscaped(const char* text, bool json) {
+  char escaped[6];
+  for (; (text != nullptr) && (*text != '\0'); text++)
+    append(Normal, escaped, TerminalUtility::escapeCharacter(*text, json, escaped));
+}
 
-void AsciiTable::printCellData(COLOR color, String line, int width) {
-  String cell = line.substring(0, width - 2);
-  String data = " " + cell + tab(cell.length(), width - 2) + " |";
-  terminal->print(color, data);
+// A CSV field, quoted when it has to be, or a "header":"cell" pair of a JSON object
+void TableWriter::field(unsigned int column, const char* text, OUTPUT_MODE mode) {
+  if (column > 0) append(Normal, ",", 1);
+  if (mode == OUTPUT_JSON) {
+    append(Normal, "\"", 1);
+    appendEscaped(columns[column].header, true);
+    append(Normal, "\":\"", 3);
+    appendEscaped(text, true);
+    append(Normal, "\"", 1);
+  } else if ((text != nullptr) && TerminalUtility::csvNeedsQuotes(text, strlen(text))) {
+    append(Normal, "\"", 1);
+    appendEscaped(text, false);
+    append(Normal, "\"", 1);
+  } else if (text != nullptr)
+    append(Normal, text, strlen(text));
 }
 
-void AsciiTable::printHeader() {
-  terminal->println();
-  for (int i = 0; i < numberOfColumns; i++) { printCellData(columnColor[i], columnHeader[i], columnWidth[i]); }
-  terminal->println();
-  for (int i = 0; i < numberOfColumns; i++) {
-    terminal->print(columnColor[i], dashes.substring(0, columnWidth[i]));
-    terminal->print(columnColor[i], "|");
+// " cell<padding> |" in the text mode, the text is cut to fit the column
+void TableWriter::cell(unsigned int column, const char* text, OUTPUT_MODE mode) {
+  if (mode != OUTPUT_TEXT) {
+    if ((mode == OUTPUT_JSON) && (column == 0)) append(Normal, "{", 1);
+    field(column, text, mode);
+    if ((mode == OUTPUT_JSON) && (column == count - 1)) append(Normal, "}", 1);
+    return;
   }
-  terminal->println();
+  COLOR color = columns[column].color;
+  size_t width = columns[column].width;
+  if (width > MAX_CELL_WIDTH) width = MAX_CELL_WIDTH;
+  if (width < 2) width = 2;
+  size_t cellWidth = width - 2;
+  size_t length = (text == nullptr) ? 0 : strnlen(text, cellWidth);
+  appendFill(color, ' ', 1);
+  append(color, text, length);
+  appendFill(color, ' ', cellWidth - length + 1);
+  appendFill(color, '|', 1);
 }
 
-void AsciiTable::printData(String line0, String line1, String line2, String line3, String line4, String line5,
-                           String line6, String line7, String line8, String line9) {
-  if (numberOfColumns > 0) printCellData(columnColor[0], line0, columnWidth[0]);
-  if (numberOfColumns > 1) printCellData(columnColor[1], line1, columnWidth[1]);
-  if (numberOfColumns > 2) printCellData(columnColor[2], line2, columnWidth[2]);
-  if (numberOfColumns > 3) printCellData(columnColor[3], line3, columnWidth[3]);
-  if (numberOfColumns > 4) printCellData(columnColor[4], line4, columnWidth[4]);
-  if (numberOfColumns > 5) printCellData(columnColor[5], line5, columnWidth[5]);
-  if (numberOfColumns > 6) printCellData(columnColor[6], line6, columnWidth[6]);
-  if (numberOfColumns > 7) printCellData(columnColor[7], line7, columnWidth[7]);
-  if (numberOfColumns > 8) printCellData(columnColor[8], line8, columnWidth[8]);
-  if (numberOfColumns > 9) printCellData(columnColor[9], line9, columnWidth[9]);
+void TableWriter::endRow() {
+  flushRun();
   terminal->println();
 }
 
-void AsciiTable::printDone(String done) {
+void TableWriter::printHeader() {
+  OUTPUT_MODE mode = terminal->getOutputMode();
+  if (mode == OUTPUT_JSON) return; // Every object carries the headers
+  if (mode == OUTPUT_CSV) {
+    for (unsigned int i = 0; i < count; i++) cell(i, columns[i].header, mode);
+    endRow();
+    return;
+  }
   terminal->println();
+  for (unsigned int i = 0; i < count; i++) cell(i, columns[i].header, mode);
+  endRow();
+  for (unsigned int i = 0; i < count; i++) {
+    size_t width = (columns[i].width < MAX_CELL_WIDTH) ? columns[i].width : MAX_CELL_WIDTH;
+    appendFill(columns[i].color, '-', width);
+    appendFill(columns[i].color, '|', 1);
+  }
+  endRow();
+}
+
+void TableWriter::printRow(const char* const* cells) {
+  OUTPUT_MODE mode = terminal->getOutputMode();
+  for (unsigned int i = 0; i < count; i++) cell(i, cells[i], mode);
+  endRow();
+}
+
+void TableWriter::printRow(const String* cells) {
+  OUTPUT_MODE mode = terminal->getOutputMode();
+  for (unsigned int i = 0; i < count; i++) cell(i, cells[i].c_str(), mode);
+  endRow();
+}
+
+void TableWriter::printDone(String done) {
+  printDone(done.c_str());
+}
+
+void TableWriter::printDone(const char* done) {
+  if (terminal->getOutputMode() == OUTPUT_TEXT) terminal->println();
+#ifdef TERMINAL_LOGGING
+  terminal->println(PASSED, done);
+#else
+  terminal->println(done);
+#endif
+}
+
+void TableWriter::printDone(const __FlashStringHelper* done) {
+  if (terminal->getOutputMode() == OUTPUT_TEXT) terminal->println();
 #ifdef TERMINAL_LOGGING
   terminal->println(PASSED, done);
 #else
   terminal->println(done);
 #endif
 }
-} // namespace ASCIITable
\ No newline at end of file
+
+AsciiTable::AsciiTable(OutputInterface* __terminal) : TableWriter(__terminal, columnList, 0) {
+  for (int i = 0; i < MAX_TABLE_COLUMNS; i++) {
+    columnList[i].color = Normal;
+    columnList[i].header = "";
+    columnList[i].width = 0;
+  }
+  numberOfColumns = 0;
+}
+
+void AsciiTable::addColumn(COLOR color, String header, unsigned long width) {
+  if (numberOfColumns < MAX_TABLE_COLUMNS) {
+    columnHeader[numberOfColumns] = header;
+    columnList[numberOfColumns].color = color;
+    columnList[numberOfColumns].header = columnHeader[numberOfColumns].c_str();
+    columnList[numberOfColumns].width = width;
+    numberOfColumns++;
+    setCount(numberOfColumns);
+  }
+}
+
+void AsciiTable::printCellData(COLOR color, String line, int width) {
+  printCellData(color, line.c_str(), width);
+}
+
+// Builds " cell<padding> |" in place and prints it with a single call.
+void AsciiTable::printCellData(COLOR color, const char* line, int width) {
+  char data[MAX_CELL_WIDTH + 2];
+  if (width > MAX_CELL_WIDTH) width = MAX_CELL_WIDTH;
+  if (width < 2) width = 2;
+  size_t cellWidth = width - 2;
+  size_t length = (line == nullptr) ? 0 : strnlen(line, cellWidth);
+  data[0] = ' ';
+  if (length > 0) memcpy(&data[1], line, length);
+  memset(&data[1 + length], ' ', cellWidth - length);
+  data[1 + cellWidth] = ' ';
+  data[2 + cellWidth] = '|';
+  terminal->print(color, data, width + 1);
+}
+
+void AsciiTable::printData(String line0, String line1, String line2, String line3, String line4, String line5,
+                           String line6, String line7, String line8, String line9) {
+  const char* cells[MAX_TABLE_COLUMNS] = {line0.c_str(), line1.c_str(), line2.c_str(), line3.c_str(),
+                                          line4.c_str(), line5.c_str(), line6.c_str(), line7.c_str(),
+                                          line8.c_str(), line9.c_str()};
+  printRow(cells);
+}
+} // namespace ASCIITable
@@ -2,28 +2,71 @@
 #define GAVEL_ASCII_TABLE
 
 #define MAX_TABLE_COLUMNS 10
+#define TABLE_RUN_BUFFER 64 // Cells of one color are gathered here and printed with one call
 
 #include "../terminalclass.h"
 
 namespace ASCIITable {
 using namespace TerminalLibrary;
 
-class AsciiTable {
+// width counts the space on each side of the text, the '|' after the cell is extra
+struct TableColumn {
+  COLOR color;
+  const char* header;
+  unsigned int width;
+};
+
+// A table over columns owned by the caller, of any number. Rows are arrays of cells that are
+// printed as they come. Neighbouring cells of the same color are printed together, so the
+// color only changes where a column's color does. In the CSV and JSON output modes of the
+// terminal the header is a CSV line or nothing, and each row a CSV line or a JSON object
+// keyed by the headers, with the cells whole and unpadded.
+class TableWriter {
+public:
+  TableWriter(OutputInterface* __terminal, TableColumn* __columns, unsigned int __count);
+  void fitRow(const char* const* cells); // Widens the columns to fit, call with the first rows before printHeader
+  void fitRow(const String* cells);
+  void printHeader();
+  void printRow(const char* const* cells);
+  void printRow(const String* cells);
+  void printDone(String done);
+  void printDone(const char* done);
+  void printDone(const __FlashStringHelper* done);
+
+protected:
+  OutputInterface* terminal;
+  TableColumn* columns;
+  unsigned int count;
+  void setCount(unsigned int __count) { count = __count; };
+
+private:
+  char run[TABLE_RUN_BUFFER];
+  size_t runLength = 0;
+  COLOR runColor = Normal;
+  void fit(unsigned int column, const char* text);
+  void cell(unsigned int column, const char* text, OUTPUT_MODE mode);
+  void append(COLOR color, const char* data, size_t length);
+  void appendEscaped(const char* text, bool json);
+  void field(unsigned int column, const char* text, OUTPUT_MODE mode);
+  void appendFill(COLOR color, char fill, size_t length);
+  void flushRun();
+  void endRow();
+};
+
+// Up to MAX_TABLE_COLUMNS columns added one at a time, with the cells of a row as arguments
+class AsciiTable : public TableWriter {
 public:
   AsciiTable(OutputInterface* __terminal);
   void addColumn(COLOR color, String header, unsigned long width);
-  void printHeader();
   void printCellData(COLOR color, String line, int width);
+  void printCellData(COLOR color, const char* line, int width);
   void printData(String line0 = "", String line1 = "", String line2 = "", String line3 = "", String line4 = "",
                  String line5 = "", String line6 = "", String line7 = "", String line8 = "", String line9 = "");
-  void printDone(String done);
 
 private:
-  COLOR columnColor[MAX_TABLE_COLUMNS];
-  unsigned long columnWidth[MAX_TABLE_COLUMNS];
+  TableColumn columnList[MAX_TABLE_COLUMNS];
   String columnHeader[MAX_TABLE_COLUMNS];
   int numberOfColumns;
-  OutputInterface* terminal;
 };
 }; // namespace ASCIITable
 
@@ -0,0 +1,148 @@
+/*
+  cmdhash.h - Command Hash - A perfect hash over a static command table, built by the compiler.
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#ifndef __TERMINAL_COMMAND_HASH
+#define __TERMINAL_COMMAND_HASH
+
+#include "termcmd.h"
+
+#include <stdint.h>
+
+// Builds the hash of a constexpr CmdEntry table, pass the result to TerminalCommand::setStaticTable
+#define TERMINAL_CMD_HASH(table) (&TerminalLibrary::CmdHashTable<table, sizeof(table) / sizeof(table[0])>::hash)
+
+namespace TerminalLibrary {
+// Two levels, in the style of FKS: the hash of a name picks a bucket, and the bucket's seed spreads
+// its few names over a private range of slots without collisions. Each slot holds a table index.
+// Everything below is C++11 constexpr so it also builds for AVR. Every step is kept in a constexpr
+// array, so each value is computed once and the recursion stays shallow.
+namespace CmdHashBuild {
+static const unsigned int MAX_SEED = 64;
+
+constexpr uint32_t hashString(const char* name, uint32_t hash = CMD_HASH_BASIS) {
+  return (*name == '\0') ? hash : hashString(name + 1, (uint32_t) ((hash ^ (unsigned char) *name) * CMD_HASH_PRIME));
+}
+
+constexpr unsigned int bucketCount(unsigned int count, unsigned int buckets = 1) {
+  return (buckets >= count) ? buckets : bucketCount(count, buckets * 2);
+}
+
+constexpr unsigned char countIn(const uint32_t* keys, unsigned int n, unsigned int mask, unsigned int bucket) {
+  return (n == 0) ? 0 : ((keys[0] & mask) == bucket) + countIn(keys + 1, n - 1, mask, bucket);
+}
+
+// Bits of slot index for a bucket of count names, count squared slots, at most 8 names
+constexpr unsigned char slotBits(unsigned int count) {
+  return (count <= 1) ? 0 : (count <= 2) ? 2 : (count <= 4) ? 4 : (count <= 8) ? 6 : 0xFF;
+}
+
+// Whether seed places the names of bucket in distinct slots
+constexpr bool seedFits(const uint32_t* keys, unsigned int n, unsigned int mask, unsigned int bucket,
+                        unsigned int seed, unsigned char bits, uint64_t used = 0) {
+  return (n == 0)                       ? true
+         : ((keys[0] & mask) != bucket) ? seedFits(keys + 1, n - 1, mask, bucket, seed, bits, used)
+         : (used & ((uint64_t) 1 << cmdHashSlot(keys[0], seed, bits)))
+             ? false
+             : seedFits(keys + 1, n - 1, mask, bucket, seed, bits,
+                        used | ((uint64_t) 1 << cmdHashSlot(keys[0], seed, bits)));
+}
+
+constexpr unsigned char findSeed(const uint32_t* keys, unsigned int n, unsigned int mask, unsigned int bucket,
+                                 unsigned char bits, unsigned int candidate = 0) {
+  return ((bits == 0xFF) || (candidate == MAX_SEED))          ? MAX_SEED
+         : seedFits(keys, n, mask, bucket, candidate, bits) ? candidate
+                                                              : findSeed(keys, n, mask, bucket, bits, candidate + 1);
+}
+
+constexpr unsigned int slotsOf(unsigned char count, unsigned char bits) {
+  return (count == 0) ? 0 : (1u << bits);
+}
+
+// Slots used by the buckets before bucket
+constexpr unsigned int offset(const unsigned char* counts, const unsigned char* bits, unsigned int bucket) {
+  return (bucket == 0) ? 0 : slotsOf(counts[0], bits[0]) + offset(counts + 1, bits + 1, bucket - 1);
+}
+
+constexpr unsigned char owner(const unsigned short* positions, unsigned int n, unsigned int slot, unsigned int i = 0) {
+  return (i == n) ? CMD_HASH_EMPTY : (positions[i] == slot) ? (unsigned char) i : owner(positions, n, slot, i + 1);
+}
+
+constexpr bool allFound(const unsigned char* seeds, unsigned int n) {
+  return (n == 0) ? true : (seeds[0] != MAX_SEED) && allFound(seeds + 1, n - 1);
+}
+
+constexpr bool allPlaced(const unsigned short* positions, unsigned int n, unsigned int i = 0) {
+  return (i == n) ? true : (owner(positions, n, positions[i]) == i) && allPlaced(positions, n, i + 1);
+}
+
+template <unsigned int... I> struct Sequence {};
+template <unsigned int N, unsigned int... I> struct MakeSequence : MakeSequence<N - 1, N - 1, I...> {};
+template <unsigned int... I> struct MakeSequence<0, I...> {
+  typedef Sequence<I...> type;
+};
+
+template <const CmdEntry* Table, unsigned int N, typename Names, typename Buckets> struct Layout;
+template <const CmdEntry* Table, unsigned int N, unsigned int... I, unsigned int... B>
+struct Layout<Table, N, Sequence<I...>, Sequence<B...>> {
+  static constexpr unsigned int MASK = sizeof...(B) - 1;
+  static constexpr uint32_t keys[N] = {hashString(Table[I].command)...};
+  static constexpr unsigned char counts[sizeof...(B)] = {countIn(keys, N, MASK, B)...};
+  static constexpr unsigned char bits[sizeof...(B)] = {slotBits(counts[B])...};
+  static constexpr unsigned char seeds[sizeof...(B)] = {findSeed(keys, N, MASK, B, bits[B])...};
+  static constexpr unsigned short offsets[sizeof...(B)] = {(unsigned short) offset(counts, bits, B)...};
+  static constexpr unsigned int SLOTS = offset(counts, bits, sizeof...(B));
+  static constexpr unsigned short positions[N] = {
+      (unsigned short) (offsets[keys[I] & MASK] + cmdHashSlot(keys[I], seeds[keys[I] & MASK], bits[keys[I] & MASK]))...};
+};
+
+template <const CmdEntry* Table, unsigned int N, unsigned int... I, unsigned int... B>
+constexpr uint32_t Layout<Table, N, Sequence<I...>, Sequence<B...>>::keys[N];
+template <const CmdEntry* Table, unsigned int N, unsigned int... I, unsigned int... B>
+constexpr unsigned char Layout<Table, N, Sequence<I...>, Sequence<B...>>::counts[sizeof...(B)];
+template <const CmdEntry* Table, unsigned int N, unsigned int... I, unsigned int... B>
+constexpr unsigned char Layout<Table, N, Sequence<I...>, Sequence<B...>>::bits[sizeof...(B)];
+template <const CmdEntry* Table, unsigned int N, unsigned int... I, unsigned int... B>
+constexpr unsigned char Layout<Table, N, Sequence<I...>, Sequence<B...>>::seeds[sizeof...(B)];
+template <const CmdEntry* Table, unsigned int N, unsigned int... I, unsigned int... B>
+constexpr unsigned short Layout<Table, N, Sequence<I...>, Sequence<B...>>::offsets[sizeof...(B)];
+template <const CmdEntry* Table, unsigned int N, unsigned int... I, unsigned int... B>
+constexpr unsigned short Layout<Table, N, Sequence<I...>, Sequence<B...>>::positions[N];
+
+template <typename L, unsigned int N, typename Buckets, typename Slots> struct Data;
+template <typename L, unsigned int N, unsigned int... B, unsigned int... S>
+struct Data<L, N, Sequence<B...>, Sequence<S...>> {
+  static_assert(N < CMD_HASH_EMPTY, "A hashed command table holds at most 254 commands");
+  static_assert(allFound(L::seeds, sizeof...(B)), "No perfect hash found for this command table, rename a command");
+  static_assert(allPlaced(L::positions, N), "Two commands in the table have the same name or the same hash");
+  static const CmdHashBucket buckets[sizeof...(B)];
+  static const unsigned char slots[sizeof...(S)];
+};
+
+// Empty buckets point at the extra slot after the last one, which is always empty
+template <typename L, unsigned int N, unsigned int... B, unsigned int... S>
+const CmdHashBucket Data<L, N, Sequence<B...>, Sequence<S...>>::buckets[sizeof...(B)] PROGMEM = {
+    {(unsigned short) ((L::counts[B] == 0) ? L::SLOTS : L::offsets[B]), L::bits[B], L::seeds[B]}...};
+template <typename L, unsigned int N, unsigned int... B, unsigned int... S>
+const unsigned char Data<L, N, Sequence<B...>, Sequence<S...>>::slots[sizeof...(S)] PROGMEM = {
+    owner(L::positions, N, S)...};
+} // namespace CmdHashBuild
+
+// Table must be a constexpr array, and so must the names it points to, see TERMINAL_CMD_HASH
+template <const CmdEntry* Table, unsigned int N> struct CmdHashTable {
+  static constexpr unsigned int BUCKETS = CmdHashBuild::bucketCount(N);
+  typedef CmdHashBuild::Layout<Table, N, typename CmdHashBuild::MakeSequence<N>::type,
+                               typename CmdHashBuild::MakeSequence<BUCKETS>::type>
+      Layout;
+  typedef CmdHashBuild::Data<Layout, N, typename CmdHashBuild::MakeSequence<BUCKETS>::type,
+                             typename CmdHashBuild::MakeSequence<Layout::SLOTS + 1>::type>
+      Data;
+  static const CmdHash hash;
+};
+
+template <const CmdEntry* Table, unsigned int N>
+const CmdHash CmdHashTable<Table, N>::hash = {Data::buckets, Data::slots, BUCKETS - 1};
+} // namespace TerminalLibrary
+
+#endif
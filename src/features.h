@@ -4,11 +4,14 @@
 /* Defined Feature Macros to turn on/off specific features - This can save memory or computing power */
 
 #define TERMINAL_ENABLE_DEBUG // Give the Terminal a Debug Object to register outputs with
+// #define TERMINAL_DEBUG_ASYNC // Debug prints are queued and sent to the outputs by Debug::drain()
+// #define TERMINAL_DEBUG_TOKENIZED // DBG_PRINTF also sends binary records, decoded on the host (extras/)
 #define TERMINAL_COLORS       // Gives the Terminal the escape code to print in color
 #define TERMINAL_TAB          // Tab Auto-Complete Feature
 #define TERMINAL_LOGGING      // Logging features of TRACE, INFO, WARNING, ERROR, HELP, PASSED, FAILED, PROMPT
 #define TERMINAL_BANNER       // User generated banner that is used at start-up
 #define TERMINAL_HEX_STRING   // Diagnostics prints that do HEX printing for the user
+#define TERMINAL_TASKS        // Long running commands that resume from loop instead of blocking
 
 #define TERMINAL_STANDARD_COMMANDS_TERMINAL_HELP
 #define TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
@@ -21,10 +24,20 @@
 /*******************************************************/
 
 #define MAX_TERM_CMD 50
-#define MAX_INPUT_LINE 80
+#define MAX_INPUT_LINE 80 // Line length of Terminal, including the NUL
+#define TERMINAL_MAX_ARGUMENTS 16 // Most arguments a command line is split into, the command name included
+#define TERMINAL_OUTPUT_BUFFER 64 // Output is staged and sent with a single write, comment out to write directly
+#define TERMINAL_OUTPUT_BACKLOG 128 // Output a slow stream has no room for waits here, comment out to block
+#define TERMINAL_INPUT_CHUNK 32   // Bytes read from the input stream with each readBytes call
+#define TERMINAL_INPUT_BUDGET 256 // Default maximum bytes processed per loop call, see setInputBudget
+#define TERMINAL_SERVER_SESSIONS 4 // Sessions in a TerminalServer pool, comment out to remove TerminalServer
+#define TERMINAL_ESCAPE_TIMEOUT 50 // Milliseconds before a lone ESC, or a stalled escape sequence, is resolved
 
+// Defaults for Terminal, a BasicTerminal<LineLength, HistoryDepth> can be sized per instance
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
 #define HISTORY_BUFFER 10
+#else
+#define HISTORY_BUFFER 0
 #endif
 
 #endif
\ No newline at end of file
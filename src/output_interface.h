@@ -7,7 +7,9 @@
 #define __OUTPUT_INTERFACE
 
 #include "features.h"
-#include "utility/queue.h"
+#include "termparam.h"
+#include "utility/hexDump.h"
+#include "utility/history.h"
 
 #include <Arduino.h>
 
@@ -19,31 +21,117 @@ namespace TerminalLibrary {
 typedef enum { TRACE, INFO, WARNING, ERROR, HELP, PASSED, FAILED, PROMPT } PRINT_TYPES;
 #endif
 
-typedef enum { Normal = 0, Black = 30, Red, Green, Yellow, Blue, Magenta, Cyan, White } COLOR;
+typedef enum { FLUSH_ON_NEWLINE, FLUSH_ON_FULL } FLUSH_POLICY;
+
+// What a terminal does when its stream has no room and the backlog is full. BACKPRESSURE_DROP
+// discards output until the backlog drains and marks the gap, BACKPRESSURE_DISCONNECT drops the stream.
+typedef enum { BACKPRESSURE_BLOCK, BACKPRESSURE_DROP, BACKPRESSURE_DISCONNECT } BACKPRESSURE_POLICY;
+
+// Machine readable modes print no colors, padding or log headers. A log line becomes a record of
+// its level and message, a table row a CSV line or a JSON object.
+typedef enum { OUTPUT_TEXT, OUTPUT_CSV, OUTPUT_JSON } OUTPUT_MODE;
+
+#ifdef TERMINAL_HEX_STRING
+// Options of hexdump, or'ed together
+using TerminalUtility::HEXDUMP_PLAIN;
+using TerminalUtility::HEXDUMP_ASCII;
+using TerminalUtility::HEXDUMP_SQUEEZE;
+using TerminalUtility::HEXDUMP_PROGMEM;
+#endif
+
+// Bold can be or'ed into any color, Palette + 0..255 is a color of the 256 color palette
+typedef enum {
+  Normal = 0,
+  Black = 30,
+  Red,
+  Green,
+  Yellow,
+  Blue,
+  Magenta,
+  Cyan,
+  White,
+  Bold = 0x100,
+  Palette = 0x200
+} COLOR;
+
+constexpr COLOR paletteColor(unsigned char index) {
+  return (COLOR) (Palette | index);
+}
+constexpr COLOR boldColor(COLOR color) {
+  return (COLOR) (color | Bold);
+}
+
+class OutputInterface;
+
+#ifdef TERMINAL_TASKS
+typedef enum { TASK_DONE, TASK_RUNNING } TASK_STATUS;
+
+class TerminalTask;
+typedef TASK_STATUS (*TaskFunction)(OutputInterface* terminal, TerminalTask* task);
+typedef void (*TaskAbortFunction)(OutputInterface* terminal, TerminalTask* task);
+
+// State of a long running command. The function is called again from loop() once wake has
+// passed, until it returns TASK_DONE. state, value and data belong to the function. abort, when
+// set, is called instead if the task is stopped before it is done, to release data.
+class TerminalTask {
+public:
+  TaskFunction function = nullptr;
+  TaskAbortFunction abort = nullptr;
+  unsigned long wake = 0;
+  unsigned long state = 0;
+  long value = 0;
+  void* data = nullptr;
+  void sleep(unsigned long milliseconds) { wake = millis() + milliseconds; };
+};
+#endif
 
 class OutputInterface {
 public:
   virtual void println() = 0;
   virtual void print(COLOR color, String line) = 0;
+  virtual void print(COLOR color, const char* line) = 0;
+  virtual void print(COLOR color, const char* line, size_t length) = 0;
+  virtual void print(COLOR color, const __FlashStringHelper* line) = 0;
 #ifdef TERMINAL_LOGGING
   virtual void print(PRINT_TYPES type, String line) = 0;
+  virtual void print(PRINT_TYPES type, const char* line) = 0;
+  virtual void print(PRINT_TYPES type, const char* line, size_t length) = 0;
+  virtual void print(PRINT_TYPES type, const __FlashStringHelper* line) = 0;
   virtual void print(PRINT_TYPES type, String line, String line2) = 0;
+  virtual void print(PRINT_TYPES type, const char* line, const char* line2) = 0;
+  virtual void print(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2) = 0;
   virtual void println(PRINT_TYPES type, String line) = 0;
+  virtual void println(PRINT_TYPES type, const char* line) = 0;
+  virtual void println(PRINT_TYPES type, const char* line, size_t length) = 0;
+  virtual void println(PRINT_TYPES type, const __FlashStringHelper* line) = 0;
   virtual void println(PRINT_TYPES type, String line, String line2) = 0;
+  virtual void println(PRINT_TYPES type, const char* line, const char* line2) = 0;
+  virtual void println(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2) = 0;
+#endif
   virtual void print(String line) = 0;
+  virtual void print(const char* line) = 0;
+  virtual void print(const char* line, size_t length) = 0;
+  virtual void print(const __FlashStringHelper* line) = 0;
   virtual void println(String line) = 0;
-#else
-  virtual void print(String line) = 0;
-  virtual void println(String line) = 0;
-#endif
+  virtual void println(const char* line) = 0;
+  virtual void println(const char* line, size_t length) = 0;
+  virtual void println(const __FlashStringHelper* line) = 0;
 #ifdef TERMINAL_HEX_STRING
-  virtual void hexdump(unsigned char* buffer, unsigned long length) = 0;
+  virtual void hexdump(const unsigned char* buffer, unsigned long length, unsigned int options = HEXDUMP_PLAIN) = 0;
 #endif
 #ifdef TERMINAL_BANNER
   virtual void banner() = 0;
 #endif
   virtual void prompt() = 0;
+  virtual void flush() = 0;
+  virtual void setBackpressure(BACKPRESSURE_POLICY __backpressure) = 0;
+  virtual BACKPRESSURE_POLICY getBackpressure() = 0;
+  virtual unsigned long getStalls() = 0;
+  virtual unsigned long getDropped() = 0;
   virtual char* readParameter() = 0;
+  virtual unsigned int getArgc() = 0;
+  virtual char* getArgv(unsigned int index) = 0;
+  virtual bool readParameters(const ParamSpec* specs, unsigned int count, ParamValue* values) = 0;
   virtual void invalidParameter() = 0;
   virtual void setEcho(bool __echo) = 0;
   virtual bool getEcho() = 0;
@@ -52,6 +140,8 @@ public:
   virtual void setColor(bool __usecolor) = 0;
   virtual bool getColor() = 0;
 #endif
+  virtual void setOutputMode(OUTPUT_MODE __outputMode) = 0;
+  virtual OUTPUT_MODE getOutputMode() = 0;
   virtual void setPrompt(bool __useprompt) = 0;
   virtual bool getPrompt() = 0;
   virtual String getPromptString() = 0;
@@ -67,9 +157,11 @@ public:
   virtual void clearHistory() = 0;
 #endif
   virtual void setTokenizer(String token) = 0;
-  virtual char* getTokenizer() = 0;
+  virtual String getTokenizer() = 0;
 
-  virtual TerminalUtility::Queue* getLastBuffer() = 0;
+  virtual TerminalUtility::History* getHistory() = 0;
+  virtual unsigned int getMaxInputLine() = 0;
+  virtual size_t getMemoryUsage() = 0;
 
   virtual void setStream(Stream* __stream) = 0;
   virtual void setStream(Stream* __inputStream, Stream* __outputStream) = 0;
@@ -78,6 +170,12 @@ public:
 
   virtual void setContext(unsigned int i, void* ptr) = 0;
   virtual void* getContext(unsigned int i) = 0;
+
+#ifdef TERMINAL_TASKS
+  virtual void startTask(TaskFunction function, long value = 0, void* data = nullptr,
+                         TaskAbortFunction abort = nullptr) = 0;
+  virtual bool taskRunning() = 0;
+#endif
 };
 
 }; // namespace TerminalLibrary
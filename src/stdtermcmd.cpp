@@ -33,8 +33,8 @@ void bannerCommand(OutputInterface* terminal);
 
 void addStandardTerminalCommands(TerminalCommand* __termCmd) {
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HELP
-  __termCmd->addCmd("?", "", "Print Help", help);
-  __termCmd->addCmd("help", "", "Print Help", help);
+  __termCmd->addCmd("?", "[prefix]", "Print Help", help);
+  __termCmd->addCmd("help", "[prefix]", "Print Help", help);
 #ifdef TERMINAL_BANNER
   __termCmd->addCmd("banner", "", "Print Banner", bannerCommand);
 #endif
@@ -46,8 +46,8 @@ void addStandardTerminalCommands(TerminalCommand* __termCmd) {
   __termCmd->addCmd("reset", "", "Reset the Terminal", resetTerminal);
 #endif
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_STTY
-  __termCmd->addCmd("stty", "echo|-echo|color|-color|prompt|-prompt",
-                    "Enables/Disables Terminal Echo, Color, or Prompt", sttyCommand);
+  __termCmd->addCmd("stty", "[-]echo|[-]color|[-]prompt|text|csv|json",
+                    "Enables/Disables Terminal Echo, Color, or Prompt, or sets the Output Mode", sttyCommand);
 #endif
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
   __termCmd->addCmd("history", "", "Command History", history);
@@ -65,83 +65,98 @@ constexpr size_t kMaxDescLen = 96;
 constexpr size_t kMaxLhsLen = kMaxCmdLen + 1 + kMaxParamLen; // "cmd param"
 } // namespace
 
-void help(OutputInterface* terminal) {
-#ifdef TERMINAL_BANNER
-  terminal->banner();
-#endif
-
-  const int count = TERM_CMD->getCmdCount();
-  size_t maxWidth = 0;
-
-  // First pass: compute display width (clamped)
-  for (int i = 0; i < count; ++i) {
-    const String cmd = TERM_CMD->getCmd(i);
-    const String param = TERM_CMD->getParameter(i);
-    const bool hasParam = param.length() > 0;
+// Copies text, from flash when flash is set, and returns the position after it
+static size_t appendText(char* buffer, size_t position, size_t size, const char* text, bool flash) {
+  size_t length = (flash) ? strlen_P(text) : strlen(text);
+  if (length > size - position) length = size - position;
+  if (flash)
+    memcpy_P(buffer + position, text, length);
+  else
+    memcpy(buffer + position, text, length);
+  return position + length;
+}
 
-    size_t width = cmd.length() + (hasParam ? (1 + param.length()) : 0);
-    if (width > kMaxLhsLen) width = kMaxLhsLen; // clamp to buffer capacity
-    if (width > maxWidth) maxWidth = width;
+// One line straight from the strings of the command, without making Strings of them
+static void helpLine(OutputInterface* terminal, int index, size_t width) {
+  bool flash;
+  CmdEntry entry = TERM_CMD->getEntry(index, &flash);
+  char lhs[kMaxLhsLen + 1];
+  size_t pos = appendText(lhs, 0, kMaxLhsLen, entry.command, flash);
+  char parameter = (flash) ? (char) pgm_read_byte(entry.parameter) : *entry.parameter;
+  if ((parameter != '\0') && (pos < kMaxLhsLen)) {
+    lhs[pos++] = ' ';
+    pos = appendText(lhs, pos, kMaxLhsLen, entry.parameter, flash);
   }
+  // Columns are only lined up for people, a record carries the fields as they are
+  if (terminal->getOutputMode() == OUTPUT_TEXT)
+    while (pos < width) lhs[pos++] = ' ';
+  lhs[pos] = '\0';
 
-  // Second pass: build and print
-  for (int i = 0; i < count; ++i) {
-    const String cmd = TERM_CMD->getCmd(i);
-    const String param = TERM_CMD->getParameter(i);
-    const String desc = TERM_CMD->getDescription(i);
-
-    char lhs[kMaxLhsLen + 1];
-    size_t pos = 0;
-
-    // Copy cmd
-    for (size_t j = 0; j < cmd.length() && pos < kMaxLhsLen; ++j) lhs[pos++] = cmd[j];
-
-    // Optional space + param
-    if (param.length() && pos < kMaxLhsLen) {
-      lhs[pos++] = ' ';
-      for (size_t j = 0; j < param.length() && pos < kMaxLhsLen; ++j) lhs[pos++] = param[j];
-    }
+  char rhs[2 + kMaxDescLen + 1];
+  rhs[0] = ' ';
+  rhs[1] = '-';
+  rhs[appendText(rhs, 2, 2 + kMaxDescLen, entry.description, flash)] = '\0';
+#ifdef TERMINAL_LOGGING
+  terminal->println(HELP, lhs, rhs);
+#else
+  terminal->print(lhs);
+  terminal->print("- ");
+  terminal->println(&rhs[2]);
+#endif
+}
 
-    // Pad to maxWidth
-    while (pos < maxWidth && pos < kMaxLhsLen) lhs[pos++] = ' ';
-    lhs[pos] = '\0';
+// help lists every command, in the order they were added. help prefix lists the commands
+// starting with prefix, in name order, found through the sorted index.
+void help(OutputInterface* terminal) {
+  const char* prefix = terminal->readParameter();
+  size_t width = TERM_CMD->getHelpWidth(); // Kept up to date as commands are added
+  if (width > kMaxLhsLen) width = kMaxLhsLen;
 
+  if (prefix == nullptr) {
+#ifdef TERMINAL_BANNER
+    terminal->banner();
+#endif
+    const int count = TERM_CMD->getCmdCount();
+    for (int i = 0; i < count; ++i) helpLine(terminal, i, width);
+  } else {
+    SortedCursor cursor;
+    size_t common;
+    const int count = TERM_CMD->findPrefix(prefix, strlen(prefix), &cursor, &common);
+    for (int index = TERM_CMD->nextSorted(&cursor); index >= 0; index = TERM_CMD->nextSorted(&cursor))
+      helpLine(terminal, index, width);
+    if (count == 0) {
 #ifdef TERMINAL_LOGGING
-    // " - " + desc into rhs buffer
-    char rhs[3 + kMaxDescLen + 1];
-    rhs[0] = ' ';
-    rhs[1] = '-';
-    rhs[2] = ' ';
-    size_t rpos = 2;
-    for (size_t j = 0; j < desc.length() && j < kMaxDescLen; ++j) rhs[rpos++] = desc[j];
-    rhs[rpos] = '\0';
-
-    terminal->println(HELP, lhs, rhs);
+      terminal->println(WARNING, "No commands start with: ", prefix);
 #else
-    terminal->print(lhs);
-    terminal->println(String("- ") + desc);
+      terminal->print(F("No commands start with: "));
+      terminal->println(prefix);
 #endif
+    }
   }
 
-  terminal->println();
+  if (terminal->getOutputMode() == OUTPUT_TEXT) terminal->println();
   terminal->prompt();
 }
 #endif
 
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
 void history(OutputInterface* terminal) {
+  char number[24];
 #ifdef TERMINAL_LOGGING
-  terminal->println(INFO, "Command History");
-  for (unsigned long i = 0; i < terminal->getLastBuffer()->size(); i++)
-    terminal->println(HELP, String(i + 1) + ". ", (char*) terminal->getLastBuffer()->get(i));
-  terminal->println(PASSED, "Command History");
+  terminal->println(INFO, F("Command History"));
+  for (unsigned long i = 0; i < terminal->getHistory()->size(); i++) {
+    snprintf(number, sizeof(number), "%lu. ", i + 1);
+    terminal->println(HELP, number, terminal->getHistory()->get(i));
+  }
+  terminal->println(PASSED, F("Command History"));
 #else
-  terminal->println("Command History");
-  for (unsigned long i = 0; i < terminal->getLastBuffer()->size(); i++) {
-    terminal->print(String(i + 1) + ". ");
-    terminal->println((char*) terminal->getLastBuffer()->get(i));
+  terminal->println(F("Command History"));
+  for (unsigned long i = 0; i < terminal->getHistory()->size(); i++) {
+    snprintf(number, sizeof(number), "%lu. ", i + 1);
+    terminal->print(number);
+    terminal->println(terminal->getHistory()->get(i));
   }
-  terminal->println("Command History");
+  terminal->println(F("Command History"));
 #endif
   terminal->prompt();
 }
@@ -168,104 +183,124 @@ void resetTerminal(OutputInterface* terminal) {
 #endif
 
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_STTY
+// Sorted for the binary search, the order of STTY_SETTING
+static const char sttyColorOff[] PROGMEM = "-color";
+static const char sttyEchoOff[] PROGMEM = "-echo";
+static const char sttyPromptOff[] PROGMEM = "-prompt";
+static const char sttyColorOn[] PROGMEM = "color";
+static const char sttyCsv[] PROGMEM = "csv";
+static const char sttyEchoOn[] PROGMEM = "echo";
+static const char sttyJson[] PROGMEM = "json";
+static const char sttyPromptOn[] PROGMEM = "prompt";
+static const char sttyText[] PROGMEM = "text";
+static const char* const sttyChoices[] PROGMEM = {sttyColorOff, sttyEchoOff, sttyPromptOff, sttyColorOn, sttyCsv,
+                                                  sttyEchoOn,   sttyJson,    sttyPromptOn,  sttyText};
+typedef enum {
+  STTY_COLOR_OFF,
+  STTY_ECHO_OFF,
+  STTY_PROMPT_OFF,
+  STTY_COLOR_ON,
+  STTY_CSV,
+  STTY_ECHO_ON,
+  STTY_JSON,
+  STTY_PROMPT_ON,
+  STTY_TEXT
+} STTY_SETTING;
+static const char sttySettingName[] PROGMEM = "setting";
+static const ParamSpec sttyParameters[] PROGMEM = {paramEnum(sttySettingName, sttyChoices, 9)};
+
 void sttyCommand(OutputInterface* terminal) {
-  bool passed = false;
-  String value = terminal->readParameter();
-  if (value != NULL) {
-    if (value.equals("echo")) {
-      terminal->setEcho(true);
-      passed = true;
-    }
-    if (value.equals("-echo")) {
-      terminal->setEcho(false);
-      passed = true;
-    }
-    if (value.equals("color")) {
-      terminal->setColor(true);
-      passed = true;
-    }
-    if (value.equals("-color")) {
-      terminal->setColor(false);
-      passed = true;
-    }
-    if (value.equals("prompt")) {
-      terminal->setPrompt(true);
-      passed = true;
-    }
-    if (value.equals("-prompt")) {
-      terminal->setPrompt(false);
-      passed = true;
-    }
+  ParamValue setting;
+  if (!terminal->readParameters(sttyParameters, 1, &setting)) return;
+  switch (setting.integer) {
+  case STTY_ECHO_ON: terminal->setEcho(true); break;
+  case STTY_ECHO_OFF: terminal->setEcho(false); break;
+#ifdef TERMINAL_COLORS
+  case STTY_COLOR_ON: terminal->setColor(true); break;
+  case STTY_COLOR_OFF: terminal->setColor(false); break;
+#endif
+  case STTY_PROMPT_ON: terminal->setPrompt(true); break;
+  case STTY_PROMPT_OFF: terminal->setPrompt(false); break;
+  case STTY_TEXT: terminal->setOutputMode(OUTPUT_TEXT); break;
+  case STTY_CSV: terminal->setOutputMode(OUTPUT_CSV); break;
+  case STTY_JSON: terminal->setOutputMode(OUTPUT_JSON); break;
+  default: terminal->invalidParameter();
   }
-  if (!passed) terminal->invalidParameter();
   terminal->prompt();
 }
 #endif
 
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_DIAGNOSTICS
-void diagCommand(OutputInterface* terminal) {
-  terminal->println();
-#ifdef TERMINAL_LOGGING
-  terminal->println(PROMPT, "Terminal Diagnostics");
-  terminal->print(INFO, "Standard Commands: ");
-
+// One line, so it is one record in the machine readable output modes
+static const char diagCommands[] PROGMEM = "Standard Commands: "
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HELP
-  terminal->print(HELP, "help, ");
+                                           "help, "
 #endif
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-  terminal->print(HELP, "history, ");
+                                           "history, "
 #endif
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_CLEAR
-  terminal->print(HELP, "clear, ");
+                                           "clear, "
 #endif
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_RESET
-  terminal->print(HELP, "reset, ");
+                                           "reset, "
 #endif
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_STTY
-  terminal->print(HELP, "stty, ");
+                                           "stty, "
 #endif
-  terminal->println(HELP, "diag.");
+                                           "diag.";
 
-  terminal->println(HELP, "Maximum Input String: ", String((int) MAX_INPUT_LINE));
-  terminal->println(HELP, "Current Number of Commands: ", String(TERM_CMD->getCmdCount()));
-  terminal->println(HELP, "Maximum Commands Allowed: ", String((int) MAX_TERM_CMD));
-  terminal->println(HELP, "RAM Usage Terminal: ", String(sizeof(*terminal)) + " bytes");
-  terminal->println(HELP, "RAM Usage Commands: ", String(sizeof(*TERM_CMD)) + " bytes");
-  terminal->println();
-  terminal->println(PASSED, "Terminal Diagnostics");
-#else
-  terminal->println("Terminal Diagnostics");
-  terminal->print("Standard Commands: ");
+void diagCommand(OutputInterface* terminal) {
+  char number[24];
+  bool text = terminal->getOutputMode() == OUTPUT_TEXT;
+  if (text) terminal->println();
+#ifdef TERMINAL_LOGGING
+  terminal->println(PROMPT, F("Terminal Diagnostics"));
+  terminal->println(HELP, reinterpret_cast<const __FlashStringHelper*>(diagCommands));
 
-#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HELP
-  terminal->print("help, ");
-#endif
-#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-  terminal->print("history, ");
-#endif
-#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_CLEAR
-  terminal->print("clear, ");
-#endif
-#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_RESET
-  terminal->print("reset, ");
-#endif
-#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_STTY
-  terminal->print("stty, ");
-#endif
-  terminal->println("diag.");
+  snprintf(number, sizeof(number), "%u", terminal->getMaxInputLine());
+  terminal->println(HELP, "Maximum Input String: ", number);
+  snprintf(number, sizeof(number), "%d", TERM_CMD->getCmdCount());
+  terminal->println(HELP, "Current Number of Commands: ", number);
+  snprintf(number, sizeof(number), "%d", (int) MAX_TERM_CMD);
+  terminal->println(HELP, "Maximum Commands Allowed: ", number);
+  snprintf(number, sizeof(number), "%u bytes", (unsigned int) terminal->getMemoryUsage());
+  terminal->println(HELP, "RAM Usage Terminal: ", number);
+  snprintf(number, sizeof(number), "%u bytes", (unsigned int) sizeof(*TERM_CMD));
+  terminal->println(HELP, "RAM Usage Commands: ", number);
+  snprintf(number, sizeof(number), "%lu", terminal->getStalls());
+  terminal->println(HELP, "Output Stalls: ", number);
+  snprintf(number, sizeof(number), "%lu bytes", terminal->getDropped());
+  terminal->println(HELP, "Output Dropped: ", number);
+  if (text) terminal->println();
+  terminal->println(PASSED, F("Terminal Diagnostics"));
+#else
+  terminal->println(F("Terminal Diagnostics"));
+  terminal->println(reinterpret_cast<const __FlashStringHelper*>(diagCommands));
 
-  terminal->print("Maximum Input String: ");
-  terminal->println(String((int) MAX_INPUT_LINE));
-  terminal->print("Current Number of Commands: ");
-  terminal->println(String(TERM_CMD->getCmdCount()));
-  terminal->print("Maximum Commands Allowed: ");
-  terminal->println(String((int) MAX_TERM_CMD));
-  terminal->print("RAM Usage Terminal: ");
-  terminal->println(String(sizeof(*terminal)) + " bytes");
-  terminal->print("RAM Usage Commands: ");
-  terminal->println(String(sizeof(*TERM_CMD)) + " bytes");
-  terminal->println();
-  terminal->println("Terminal Diagnostics");
+  terminal->print(F("Maximum Input String: "));
+  snprintf(number, sizeof(number), "%u", terminal->getMaxInputLine());
+  terminal->println(number);
+  terminal->print(F("Current Number of Commands: "));
+  snprintf(number, sizeof(number), "%d", TERM_CMD->getCmdCount());
+  terminal->println(number);
+  terminal->print(F("Maximum Commands Allowed: "));
+  snprintf(number, sizeof(number), "%d", (int) MAX_TERM_CMD);
+  terminal->println(number);
+  terminal->print(F("RAM Usage Terminal: "));
+  snprintf(number, sizeof(number), "%u bytes", (unsigned int) terminal->getMemoryUsage());
+  terminal->println(number);
+  terminal->print(F("RAM Usage Commands: "));
+  snprintf(number, sizeof(number), "%u bytes", (unsigned int) sizeof(*TERM_CMD));
+  terminal->println(number);
+  terminal->print(F("Output Stalls: "));
+  snprintf(number, sizeof(number), "%lu", terminal->getStalls());
+  terminal->println(number);
+  terminal->print(F("Output Dropped: "));
+  snprintf(number, sizeof(number), "%lu bytes", terminal->getDropped());
+  terminal->println(number);
+  if (text) terminal->println();
+  terminal->println(F("Terminal Diagnostics"));
 #endif
   terminal->prompt();
 }
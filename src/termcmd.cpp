@@ -13,6 +13,7 @@ namespace TerminalLibrary {
 
 TerminalCommand::TerminalCommand() {
   countCmd = 0;
+  memset(sortedIndex, 0, sizeof(sortedIndex));
   for (int i = 0; i < MAX_TERM_CMD; i++) {
     list[i].command = "";
     list[i].parameter = "";
@@ -25,19 +26,15 @@ TerminalCommand::TerminalCommand() {
 }
 
 int TerminalCommand::addCmd(String command, String parameterDesc, String description, void function(OutputInterface*)) {
-  int returnInt = -1;
-  if (findCmd(command) == -1) {
-    if (countCmd < MAX_TERM_CMD) {
-      list[countCmd].command = command;
-      list[countCmd].parameter = parameterDesc;
-      list[countCmd].description = description;
-      list[countCmd].function = (void*) function;
+  int returnInt = insertCmd(command);
+  if (returnInt != -1) {
+    list[returnInt].parameter = parameterDesc;
+    list[returnInt].description = description;
+    list[returnInt].function = (void*) function;
 #ifndef ARDUINO_ARCH_AVR
-      list[countCmd].handler = nullptr;
+    list[returnInt].handler = nullptr;
 #endif
-      returnInt = countCmd;
-      countCmd++;
-    }
+    widenHelp(&listHelpWidth, command.length(), parameterDesc.length());
   }
   return returnInt;
 }
@@ -45,43 +42,265 @@ int TerminalCommand::addCmd(String command, String parameterDesc, String descrip
 #ifndef ARDUINO_ARCH_AVR
 int TerminalCommand::addCmd(String command, String parameterDesc, String description,
                             std::function<void(OutputInterface*)> handler) {
-  int returnInt = -1;
-  if (findCmd(command) == -1) {
-    if (countCmd < MAX_TERM_CMD) {
-      list[countCmd].command = command;
-      list[countCmd].parameter = parameterDesc;
-      list[countCmd].description = description;
-      list[countCmd].function = nullptr;
-      list[countCmd].handler = handler;
-      returnInt = countCmd;
-      countCmd++;
-    }
+  int returnInt = insertCmd(command);
+  if (returnInt != -1) {
+    list[returnInt].parameter = parameterDesc;
+    list[returnInt].description = description;
+    list[returnInt].function = nullptr;
+    list[returnInt].handler = handler;
+    widenHelp(&listHelpWidth, command.length(), parameterDesc.length());
   }
   return returnInt;
 }
 #endif
 
+// Help lists "command parameter", the widest of them sets the column of the descriptions
+void TerminalCommand::widenHelp(unsigned int* width, size_t command, size_t parameter) {
+  size_t columns = command + ((parameter > 0) ? 1 + parameter : 0);
+  if (columns > *width) *width = columns;
+}
+
+// Orders two names the way the index does, either of them may be in flash.
+static int compareNames(const char* name, bool nameFlash, const char* other, bool otherFlash) {
+  while (true) {
+    unsigned char a = nameFlash ? pgm_read_byte(name++) : (unsigned char) *name++;
+    unsigned char b = otherFlash ? pgm_read_byte(other++) : (unsigned char) *other++;
+    if ((a != b) || (a == '\0')) return (int) a - (int) b;
+  }
+}
+
+// The table is searched in place, so it must be sorted by name with no name repeated, or already
+// added with addCmd. Returns false, and keeps the previous table, when it is not. With a hash from
+// TERMINAL_CMD_HASH(table) a name is found in the table without searching.
+bool TerminalCommand::setStaticTable(const CmdEntry* table, int count, const CmdHash* hash) {
+  if (table == nullptr) count = 0;
+  const char* previous = nullptr;
+  int rank = 0;
+  unsigned int width = 0;
+  for (int i = 0; i < count; i++) {
+    const char* name = (const char*) pgm_read_ptr(&table[i].command);
+    widenHelp(&width, strlen_P(name), strlen_P((const char*) pgm_read_ptr(&table[i].parameter)));
+    if ((previous != nullptr) && (compareNames(previous, true, name, true) >= 0)) return false;
+    while ((rank < countCmd) && (compareNames(list[sortedIndex[rank]].command.c_str(), false, name, true) < 0)) rank++;
+    if ((rank < countCmd) && (compareNames(list[sortedIndex[rank]].command.c_str(), false, name, true) == 0))
+      return false;
+    previous = name;
+  }
+  staticTable = table;
+  staticCount = count;
+  staticHash = (count > 0) ? hash : nullptr;
+  tableHelpWidth = width;
+  return true;
+}
+
+// Stores the command name in the next free slot and links it into the sorted index.
+// Returns the new slot, or -1 if the command already exists or the list is full.
+int TerminalCommand::insertCmd(const String& command) {
+  bool found = false;
+  lowerBound(true, command.c_str(), command.length(), &found);
+  if (found) return -1;
+  int position = lowerBound(false, command.c_str(), command.length(), &found);
+  if (found || (countCmd >= MAX_TERM_CMD)) return -1;
+  memmove(&sortedIndex[position + 1], &sortedIndex[position], (countCmd - position) * sizeof(CmdIndex));
+  sortedIndex[position] = (CmdIndex) countCmd;
+  list[countCmd].command = command;
+  return countCmd++;
+}
+
+int TerminalCommand::compareCmd(int index, const char* command, size_t length) {
+  bool flash;
+  const char* name = cmdName(index, &flash);
+  int compare = (flash) ? -strncmp_P(command, name, length) : strncmp(name, command, length);
+  if (compare == 0) { // Longer name sorts after its prefix
+    char next = (flash) ? (char) pgm_read_byte(name + length) : name[length];
+    if (next != '\0') compare = 1;
+  }
+  return compare;
+}
+
+// Binary search of the list's sorted index, or of the static table, returns the position of
+// the first name not less than command.
+int TerminalCommand::lowerBound(bool table, const char* command, size_t length, bool* found) {
+  int count = (table) ? staticCount : countCmd;
+  int low = 0;
+  int high = count;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (compareCmd(rankedIndex(table, mid), command, length) < 0)
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  *found = (low < count) && (compareCmd(rankedIndex(table, low), command, length) == 0);
+  return low;
+}
+
 int TerminalCommand::findCmd(String command) {
-  int cmdIndex = -1;
-  for (int i = 0; i < countCmd; i++) {
-    if (command == list[i].command) cmdIndex = i;
+  return findCmd(command.c_str(), command.length());
+}
+
+int TerminalCommand::findCmd(const char* command) {
+  if (command == nullptr) return -1;
+  return findCmd(command, strlen(command));
+}
+
+int TerminalCommand::findCmd(const char* command, size_t length) {
+  if (command == nullptr) return -1;
+  bool found = false;
+  int position = lowerBound(false, command, length, &found);
+  if (found) return sortedIndex[position];
+  if (staticHash != nullptr) return findHashed(command, length);
+  position = lowerBound(true, command, length, &found);
+  return (found) ? countCmd + position : -1;
+}
+
+// One hash of the name and one compare with the only table entry it can be
+int TerminalCommand::findHashed(const char* command, size_t length) {
+  uint32_t key = CMD_HASH_BASIS;
+  for (size_t i = 0; (i < length) && (command[i] != '\0'); i++)
+    key = (uint32_t) ((key ^ (unsigned char) command[i]) * CMD_HASH_PRIME);
+  CmdHashBucket bucket;
+  memcpy_P(&bucket, &staticHash->buckets[key & staticHash->bucketMask], sizeof(CmdHashBucket));
+  unsigned char slot = pgm_read_byte(&staticHash->slots[bucket.offset + cmdHashSlot(key, bucket.seed, bucket.bits)]);
+  if ((slot == CMD_HASH_EMPTY) || (compareCmd(countCmd + slot, command, length) != 0)) return -1;
+  return countCmd + slot;
+}
+
+int TerminalCommand::comparePrefix(int index, const char* prefix, size_t length) {
+  bool flash;
+  const char* name = cmdName(index, &flash);
+  return (flash) ? -strncmp_P(prefix, name, length) : strncmp(name, prefix, length);
+}
+
+// Position after the last name, from low on, that starts with prefix
+int TerminalCommand::prefixEnd(bool table, int low, const char* prefix, size_t length) {
+  int high = (table) ? staticCount : countCmd;
+  while (low < high) {
+    int mid = (low + high) / 2;
+    if (comparePrefix(rankedIndex(table, mid), prefix, length) > 0)
+      high = mid;
+    else
+      low = mid + 1;
+  }
+  return low;
+}
+
+// All names starting with prefix are adjacent in the sorted order of the list, and of the table.
+// Returns how many there are, a cursor over them for nextSorted, and the length of the prefix
+// they all share (bash style completion).
+int TerminalCommand::findPrefix(const char* prefix, size_t length, SortedCursor* cursor, size_t* common) {
+  bool found = false;
+  int low = lowerBound(false, prefix, length, &found);
+  int end = prefixEnd(false, low, prefix, length);
+  int tableLow = lowerBound(true, prefix, length, &found);
+  int tableEnd = prefixEnd(true, tableLow, prefix, length);
+  int count = (end - low) + (tableEnd - tableLow);
+  *cursor = {low, end, tableLow, tableEnd};
+  *common = 0;
+  if (count > 0) {
+    // The matching names share exactly the prefix the lowest and highest of them share.
+    bool firstFlash, lastFlash, otherFlash;
+    const char* firstName = nullptr;
+    const char* lastName = nullptr;
+    if (end > low) {
+      firstName = cmdName(sortedIndex[low], &firstFlash);
+      lastName = cmdName(sortedIndex[end - 1], &lastFlash);
+    }
+    if (tableEnd > tableLow) {
+      const char* other = cmdName(countCmd + tableLow, &otherFlash);
+      if ((firstName == nullptr) || (compareNames(other, otherFlash, firstName, firstFlash) < 0)) {
+        firstName = other;
+        firstFlash = otherFlash;
+      }
+      other = cmdName(countCmd + tableEnd - 1, &otherFlash);
+      if ((lastName == nullptr) || (compareNames(other, otherFlash, lastName, lastFlash) > 0)) {
+        lastName = other;
+        lastFlash = otherFlash;
+      }
+    }
+    size_t i = 0;
+    while (true) {
+      char a = (firstFlash) ? (char) pgm_read_byte(firstName + i) : firstName[i];
+      char b = (lastFlash) ? (char) pgm_read_byte(lastName + i) : lastName[i];
+      if ((a == '\0') || (a != b)) break;
+      i++;
+    }
+    *common = i;
   }
-  return cmdIndex;
+  return count;
+}
+
+// Index of the next command in name order, merging the list and the table, or -1 past the end.
+// Each call compares one pair of names, so walking the whole range is linear.
+int TerminalCommand::nextSorted(SortedCursor* cursor) {
+  bool listLeft = cursor->listRank < cursor->listEnd;
+  bool tableLeft = cursor->tableRank < cursor->tableEnd;
+  if (!listLeft && !tableLeft) return -1;
+  if (listLeft && (!tableLeft || (compareNames(list[sortedIndex[cursor->listRank]].command.c_str(), false,
+                                               cmdName(countCmd + cursor->tableRank, nullptr), true) < 0)))
+    return sortedIndex[cursor->listRank++];
+  return countCmd + cursor->tableRank++;
+}
+
+// Copies the name, which may be in flash, and returns its full length
+size_t TerminalCommand::getCmdName(int index, char* buffer, size_t size) {
+  bool flash;
+  const char* name = cmdName(index, &flash);
+  size_t length = (flash) ? strlen_P(name) : strlen(name);
+  if (size == 0) return length;
+  size_t copy = (length < size) ? length : size - 1;
+  if (flash)
+    memcpy_P(buffer, name, copy);
+  else
+    memcpy(buffer, name, copy);
+  buffer[copy] = '\0';
+  return length;
+}
+
+const char* TerminalCommand::cmdName(int index, bool* flash) {
+  bool table = (index >= countCmd);
+  if (flash != nullptr) *flash = table;
+  if (table) return (const char*) pgm_read_ptr(&staticTable[index - countCmd].command);
+  return list[index].command.c_str();
+}
+
+// The strings of a command without copying them, they are in flash for the static table
+CmdEntry TerminalCommand::getEntry(int index, bool* flash) {
+  bool table = (index >= countCmd);
+  if (flash != nullptr) *flash = table;
+  if (table) return readEntry(index);
+  CmdEntry entry = {list[index].command.c_str(), list[index].parameter.c_str(), list[index].description.c_str(),
+                    (void (*)(OutputInterface*)) list[index].function};
+  return entry;
+}
+
+CmdEntry TerminalCommand::readEntry(int index) {
+  CmdEntry entry;
+  memcpy_P(&entry, &staticTable[index - countCmd], sizeof(CmdEntry));
+  return entry;
 }
 
 String TerminalCommand::getCmd(int index) {
+  if (index >= countCmd) return String(reinterpret_cast<const __FlashStringHelper*>(readEntry(index).command));
   return list[index].command;
 }
 
 String TerminalCommand::getParameter(int index) {
+  if (index >= countCmd) return String(reinterpret_cast<const __FlashStringHelper*>(readEntry(index).parameter));
   return list[index].parameter;
 }
 
 String TerminalCommand::getDescription(int index) {
+  if (index >= countCmd) return String(reinterpret_cast<const __FlashStringHelper*>(readEntry(index).description));
   return list[index].description;
 }
 
 void TerminalCommand::callFunction(int index, OutputInterface* terminal) {
+  if (index >= countCmd) {
+    CmdEntry entry = readEntry(index);
+    if (entry.function) entry.function(terminal);
+    return;
+  }
   if (list[index].function) {
     void (*cmd)(OutputInterface*) = (void (*)(OutputInterface*)) list[index].function;
     (*cmd)(terminal);
@@ -90,4 +309,4 @@ void TerminalCommand::callFunction(int index, OutputInterface* terminal) {
   if (list[index].handler) { list[index].handler(terminal); }
 #endif
 }
-} // namespace TerminalLibrary
\ No newline at end of file
+} // namespace TerminalLibrary
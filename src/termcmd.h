@@ -11,12 +11,23 @@
 #include "output_interface.h"
 
 #include <Arduino.h>
+#include <stdint.h>
 #ifndef ARDUINO_ARCH_AVR
 #include <functional>
 #endif
 
 #define TERM_CMD terminalCommand_Ptr
 
+#define CMD_HASH_BASIS 2166136261UL // 32 bit FNV-1a
+#define CMD_HASH_PRIME 16777619UL
+#define CMD_HASH_EMPTY 0xFF
+
+#if MAX_TERM_CMD > 255
+typedef unsigned short CmdIndex;
+#else
+typedef unsigned char CmdIndex;
+#endif
+
 namespace TerminalLibrary {
 class CmdItem {
 public:
@@ -29,6 +40,41 @@ public:
 #endif
 };
 
+// A command known at compile time. A sorted array of these is used in place, so the entries take
+// no RAM. On AVR the array and the strings it points to must be PROGMEM, elsewhere const is enough.
+struct CmdEntry {
+  const char* command;
+  const char* parameter;
+  const char* description;
+  void (*function)(OutputInterface*);
+};
+
+// Perfect hash of a static table, made by TERMINAL_CMD_HASH in cmdhash.h. Both arrays are PROGMEM.
+struct CmdHashBucket {
+  unsigned short offset; // First slot of the bucket
+  unsigned char bits;    // The bucket has 1 << bits slots
+  unsigned char seed;
+};
+
+struct CmdHash {
+  const CmdHashBucket* buckets;
+  const unsigned char* slots; // Table index, or CMD_HASH_EMPTY
+  unsigned int bucketMask;
+};
+
+// Slot of a name within its bucket, from the top bits of a multiplicative hash of its key
+constexpr unsigned int cmdHashSlot(uint32_t key, unsigned int seed, unsigned char bits) {
+  return (bits == 0) ? 0 : (unsigned int) ((uint32_t) ((key ^ seed) * 2654435761UL) >> (32 - bits));
+}
+
+// Walks a range of names in sorted order, one rank of the list or the table at a time (see findPrefix)
+struct SortedCursor {
+  int listRank;
+  int listEnd;
+  int tableRank;
+  int tableEnd;
+};
+
 class TerminalCommand {
 public:
   TerminalCommand();
@@ -36,16 +82,44 @@ public:
 #ifndef ARDUINO_ARCH_AVR
   int addCmd(String command, String parameterDesc, String description, std::function<void(OutputInterface*)> handler);
 #endif
-  int getCmdCount() { return countCmd; };
+  bool setStaticTable(const CmdEntry* table, int count, const CmdHash* hash = nullptr);
+  int getStaticCount() { return staticCount; };
+  int getCmdCount() { return countCmd + staticCount; };
   int findCmd(String command);
+  int findCmd(const char* command);
+  int findCmd(const char* command, size_t length);
+  int findPrefix(const char* prefix, size_t length, SortedCursor* cursor, size_t* common);
+  int nextSorted(SortedCursor* cursor);
+  size_t getCmdName(int index, char* buffer, size_t size);
+  CmdEntry getEntry(int index, bool* flash);
+  unsigned int getHelpWidth() { return (listHelpWidth > tableHelpWidth) ? listHelpWidth : tableHelpWidth; };
   String getCmd(int index);
   String getParameter(int index);
   String getDescription(int index);
   void callFunction(int index, OutputInterface* terminal);
 
 private:
+  int lowerBound(bool table, const char* command, size_t length, bool* found);
+  int prefixEnd(bool table, int low, const char* prefix, size_t length);
+  int compareCmd(int index, const char* command, size_t length);
+  int comparePrefix(int index, const char* prefix, size_t length);
+  int findHashed(const char* command, size_t length);
+  int rankedIndex(bool table, int rank) { return table ? countCmd + rank : sortedIndex[rank]; };
+  const char* cmdName(int index, bool* flash);
+  CmdEntry readEntry(int index);
+  int insertCmd(const String& command);
+  static void widenHelp(unsigned int* width, size_t command, size_t parameter);
+
+  // Commands added at run time, an overlay on the static table. Index 0 to countCmd - 1 are
+  // list entries, the static table follows from index countCmd.
   CmdItem list[MAX_TERM_CMD];
+  CmdIndex sortedIndex[MAX_TERM_CMD]; // Indexes into list, ordered by command name
   int countCmd;
+  const CmdEntry* staticTable = nullptr;
+  int staticCount = 0;
+  const CmdHash* staticHash = nullptr;
+  unsigned int listHelpWidth = 0; // Kept as commands are added, for help
+  unsigned int tableHelpWidth = 0;
 };
 } // namespace TerminalLibrary
 
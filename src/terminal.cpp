@@ -8,17 +8,27 @@
 #include "termcmd.h"
 #include "terminalclass.h"
 #include "utility/characterCodes.h"
+#include "utility/fieldEscape.h"
 
 #include <Arduino.h>
 namespace TerminalLibrary {
+TerminalBase::TerminalBase(Stream* __inputStream, Stream* __outputStream, char* memory, unsigned int __lineLength,
+                           unsigned int __historyDepth, unsigned int __features, const FeatureCode* __featureCode)
+    : lineLength(__lineLength), features(__features), featureCode(__featureCode), inputStream(__inputStream),
+      outputStream(__outputStream), cmdBuffer(memory, __lineLength), parameterParsing(memory + __lineLength),
+      screenLine(memory + 2 * __lineLength),
+      history((__historyDepth > 0) ? memory + 3 * __lineLength : nullptr, __historyDepth * __lineLength) {
+  initialize();
+}
+
 #ifdef TERMINAL_BANNER
-void Terminal::banner() {
+void TerminalBase::banner() {
   if (bannerFunction == nullptr) {
-    println();
+    if (outputMode == OUTPUT_TEXT) println();
 #ifdef TERMINAL_LOGGING
-    println(PROMPT, "Arduino Program");
+    println(PROMPT, F("Arduino Program"));
 #else
-    println("Arduino Program");
+    println(F("Arduino Program"));
 #endif
   } else {
     (*bannerFunction)(this);
@@ -26,43 +36,293 @@ void Terminal::banner() {
 }
 #endif
 
-void Terminal::prompt() {
-  if (useprompt)
+// The prompt, like the blank lines around messages, is only for people and never sent in the
+// machine readable output modes
+void TerminalBase::printPrompt() {
+  if (useprompt && (outputMode == OUTPUT_TEXT)) {
 #ifdef TERMINAL_LOGGING
-    print(PROMPT, promptString + " ");
+    printTypeColor(PROMPT);
+#endif
+    __print(promptString);
+    __write(" ", 1);
+    printColor(Normal);
+  }
+}
+
+// The screen is valid only after the flush, which may still send the color reset
+void TerminalBase::prompt() {
+  if (recordOpen) println(); // A command may end on a piece of a record
+  printPrompt();
+  flush();
+  screenLength = 0;
+  screenCursor = 0;
+  screenValid = true;
+}
+
+// Output at rest is left in the color last asked for, which is Normal after every print
+void TerminalBase::flush() {
+#ifdef TERMINAL_COLORS
+  if (featureCode->applyColor != nullptr) (this->*featureCode->applyColor)();
+#endif
+  sendOutput();
+}
+
+void TerminalBase::sendOutput() {
+#ifdef TERMINAL_OUTPUT_BUFFER
+  if (outputLength > 0) send(outputBuffer, outputLength);
+  outputLength = 0;
+#endif
+#ifdef TERMINAL_OUTPUT_BACKLOG
+  drain();
+#endif
+}
+
+#ifdef TERMINAL_OUTPUT_BACKLOG
+static const char droppedMarker[] = "\r\n[ output dropped ]\r\n";
+
+// How much of length the stream takes without waiting. Print::availableForWrite is 0 for streams
+// that do not implement it, those are written to and waited on as before until they report room.
+size_t TerminalBase::writeRoom(size_t length) {
+  int available = outputStream->availableForWrite();
+  if (available > 0) roomReported = true;
+  if (!roomReported) return length;
+  if (available <= 0) return 0;
+  return ((size_t) available < length) ? (size_t) available : length;
+}
+
+// Sends what the stream has room for, oldest first, then the marker for dropped output.
+// Returns true when nothing is left waiting.
+bool TerminalBase::drain() {
+  if (outputStream == nullptr) return true;
+  while (!backlog.empty()) {
+    unsigned int part;
+    const char* oldest = backlog.span(&part);
+    size_t room = writeRoom(part);
+    size_t written = (room > 0) ? outputStream->write(oldest, room) : 0;
+    if (written == 0) return false;
+    backlog.drop(written);
+  }
+  if (markDropped) {
+    if (writeRoom(sizeof(droppedMarker) - 1) < sizeof(droppedMarker) - 1) return false;
+    outputStream->write(droppedMarker, sizeof(droppedMarker) - 1);
+    markDropped = false;
+  }
+  return true;
+}
+
+// Waits for the whole backlog to be written, for BACKPRESSURE_BLOCK
+void TerminalBase::writeBacklog() {
+  while (!backlog.empty()) {
+    unsigned int part;
+    const char* oldest = backlog.span(&part);
+    outputStream->write(oldest, part);
+    backlog.drop(part);
+  }
+}
+
+void TerminalBase::dropBacklog() {
+  dropped += backlog.size();
+  backlog.drop(backlog.size());
+  markDropped = false;
+}
+
+// A new stream has not reported room yet, and has not missed any output
+void TerminalBase::resetBacklog() {
+  dropBacklog();
+  roomReported = false;
+}
+#endif
+
+// Writes what the stream has room for and keeps the rest in the backlog for later loops, so a
+// congested client does not hold up the loop that the sketch and every other terminal share.
+void TerminalBase::send(const char* buffer, size_t length) {
+  if ((outputStream == nullptr) || (length == 0)) return;
+#ifdef TERMINAL_OUTPUT_BACKLOG
+  if (drain()) {
+    size_t room = writeRoom(length);
+    size_t written = (room > 0) ? outputStream->write(buffer, room) : 0;
+    if (written == length) return;
+    buffer += written;
+    length -= written;
+    stalls++;
+  }
+  if (markDropped) {
+    dropped += length;
+    return;
+  }
+  if (length <= backlog.capacity() - backlog.size()) {
+    backlog.push(buffer, length);
+    return;
+  }
+  switch (backpressure) {
+  case BACKPRESSURE_DROP:
+    dropped += length;
+    markDropped = true;
+    break;
+  case BACKPRESSURE_DISCONNECT:
+    dropped += length;
+    dropBacklog();
+    inputStream = nullptr;
+    outputStream = nullptr;
+    break;
+  default:
+    writeBacklog();
+    outputStream->write(buffer, length);
+    break;
+  }
 #else
-    print(promptString + " ");
+  outputStream->write(buffer, length);
 #endif
 }
 
-void Terminal::__print(String line) {
+// All output funnels through here. Bytes are staged in outputBuffer so a logged line
+// leaves as one write to the stream instead of one per fragment and color code.
+void TerminalBase::__emit(const char* buffer, size_t length) {
   if (outputStream == nullptr) return;
-  outputStream->print(line);
+  screenValid = false;
+#ifdef TERMINAL_OUTPUT_BUFFER
+  if (outputLength + length > TERMINAL_OUTPUT_BUFFER) sendOutput();
+  if (length > TERMINAL_OUTPUT_BUFFER) {
+    send(buffer, length);
+    return;
+  }
+  memcpy(&outputBuffer[outputLength], buffer, length);
+  outputLength += length;
+  if ((flushPolicy == FLUSH_ON_NEWLINE) && (memchr(buffer, '\n', length) != nullptr)) sendOutput();
+#else
+  send(buffer, length);
+#endif
 }
 
-void Terminal::__print(char character) {
-  __print(String(character));
+// Text inside a log record is escaped, runs of plain characters are still written in one piece
+void TerminalBase::__write(const char* buffer, size_t length) {
+  if (length == 0) return;
+#ifdef TERMINAL_COLORS
+  if (featureCode->applyColor != nullptr) (this->*featureCode->applyColor)();
+#endif
+  if (!recordOpen) {
+    __emit(buffer, length);
+    return;
+  }
+  char escaped[6];
+  size_t start = 0;
+  for (size_t i = 0; i < length; i++) {
+    unsigned int escapedLength = TerminalUtility::escapeCharacter(buffer[i], outputMode == OUTPUT_JSON, escaped);
+    if ((escapedLength == 1) && (escaped[0] == buffer[i])) continue;
+    __emit(&buffer[start], i - start);
+    __emit(escaped, escapedLength);
+    start = i + 1;
+  }
+  __emit(&buffer[start], length - start);
 }
 
-void Terminal::__println(String line) {
-  if (outputStream == nullptr) return;
-  outputStream->println(line);
+void TerminalBase::__print(String line) {
+  __write(line.c_str(), line.length());
+}
+
+void TerminalBase::__print(const char* line) {
+  if (line == nullptr) return;
+  __write(line, strlen(line));
+}
+
+// Copies a F() string out of program memory a chunk at a time, no String is created.
+void TerminalBase::__print(const __FlashStringHelper* line) {
+  if (line == nullptr) return;
+  const char* flash = (const char*) line;
+  char chunk[16];
+  size_t length;
+  do {
+    length = 0;
+    while (length < sizeof(chunk)) {
+      char character = (char) pgm_read_byte(flash++);
+      if (character == '\0') break;
+      chunk[length++] = character;
+    }
+    __write(chunk, length);
+  } while (length == sizeof(chunk));
+}
+
+void TerminalBase::__print(char character) {
+  __write(&character, 1);
 }
 
-void Terminal::__println(char character) {
-  __println(String(character));
+void TerminalBase::__println(String line) {
+  __print(line);
+  __write("\r\n", 2);
+}
+
+void TerminalBase::__println(const char* line) {
+  __print(line);
+  __write("\r\n", 2);
+}
+
+void TerminalBase::__println(const __FlashStringHelper* line) {
+  __print(line);
+  __write("\r\n", 2);
+}
+
+void TerminalBase::__println(char character) {
+  __print(character);
+  __write("\r\n", 2);
 }
 
 #ifdef TERMINAL_COLORS
-void Terminal::printColor(COLOR color) {
-  if (usecolor) {
-    char colorString[32];
-    sprintf(colorString, "\033[%dm", color);
-    __print(colorString);
+// Colors are only recorded by printColor. Before the next output, and on flush, the one SGR
+// sequence that turns what the stream shows into what was asked for is sent, if any is needed.
+void TerminalBase::applyColor() {
+  unsigned int wanted = (usecolor && (outputMode == OUTPUT_TEXT)) ? colorWanted : (unsigned int) Normal;
+  if (wanted == colorShown) return;
+  char sequence[16] = {'\033', '['}; // Longest is ESC[0;1;38;5;255m
+  size_t length = 2;
+  unsigned int shown = colorShown;
+  unsigned int color = wanted & ~Bold;
+  if (((shown & Bold) && !(wanted & Bold)) || ((color == Normal) && ((shown & ~Bold) != Normal))) {
+    sequence[length++] = '0';
+    shown = Normal;
+  }
+  if ((wanted & Bold) && !(shown & Bold)) {
+    if (length > 2) sequence[length++] = ';';
+    sequence[length++] = '1';
   }
+  if ((color != Normal) && (color != (shown & ~Bold))) {
+    if (length > 2) sequence[length++] = ';';
+    if (color & Palette) {
+      unsigned char index = color & 0xFF;
+      memcpy(&sequence[length], "38;5;", 5);
+      length += 5;
+      if (index >= 100) sequence[length++] = '0' + index / 100;
+      if (index >= 10) sequence[length++] = '0' + index / 10 % 10;
+      sequence[length++] = '0' + index % 10;
+    } else if ((color >= Black) && (color <= White)) {
+      sequence[length++] = '3';
+      sequence[length++] = '0' + (color - Black);
+    }
+  }
+  colorShown = wanted;
+  if (length == 2) return;
+  sequence[length++] = 'm';
+  __emit(sequence, length);
+}
+
+void TerminalBase::print(COLOR color, String line) {
+  printColor(color);
+  __print(line);
+  printColor(Normal);
+}
+
+void TerminalBase::print(COLOR color, const char* line) {
+  printColor(color);
+  __print(line);
+  printColor(Normal);
+}
+
+void TerminalBase::print(COLOR color, const char* line, size_t length) {
+  printColor(color);
+  __write(line, length);
+  printColor(Normal);
 }
 
-void Terminal::print(COLOR color, String line) {
+void TerminalBase::print(COLOR color, const __FlashStringHelper* line) {
   printColor(color);
   __print(line);
   printColor(Normal);
@@ -70,7 +330,26 @@ void Terminal::print(COLOR color, String line) {
 #endif
 
 #ifdef TERMINAL_LOGGING
-void Terminal::printHeader(PRINT_TYPES type) {
+// Level names of machine readable records, in the order of PRINT_TYPES
+static const char levelNames[][8] PROGMEM = {"TRACE", "INFO", "WARNING", "ERROR", "HELP", "PASSED", "FAILED", "PROMPT"};
+
+// The record is closed by the next println()
+void TerminalBase::openRecord(PRINT_TYPES type) {
+  if (recordOpen) return;
+  if (outputMode == OUTPUT_JSON) __print(F("{\"level\":\""));
+  __print(reinterpret_cast<const __FlashStringHelper*>(levelNames[type]));
+  if (outputMode == OUTPUT_JSON)
+    __print(F("\",\"message\":\""));
+  else
+    __print(F(",\""));
+  recordOpen = true;
+}
+
+void TerminalBase::printHeader(PRINT_TYPES type) {
+  if (outputMode != OUTPUT_TEXT) {
+    openRecord(type);
+    return;
+  }
   printColor(Normal);
   switch (type) {
   case TRACE:
@@ -107,7 +386,10 @@ void Terminal::printHeader(PRINT_TYPES type) {
   }
 }
 
-void Terminal::print(PRINT_TYPES type, String line) {
+// In the machine readable modes a piece printed without a header still opens a record of its
+// type, so text printed in pieces is one record, closed by the next println()
+void TerminalBase::printTypeColor(PRINT_TYPES type) {
+  if (outputMode != OUTPUT_TEXT) openRecord(type);
   printColor(Normal);
   switch (type) {
   case TRACE: printColor(Cyan); break;
@@ -120,37 +402,109 @@ void Terminal::print(PRINT_TYPES type, String line) {
   case INFO:
   default: break;
   }
+}
+
+void TerminalBase::print(PRINT_TYPES type, String line) {
+  printTypeColor(type);
   __print(line);
   printColor(Normal);
 }
 
-void Terminal::print(PRINT_TYPES type, String line, String line2) {
+void TerminalBase::print(PRINT_TYPES type, const char* line) {
+  printTypeColor(type);
+  __print(line);
   printColor(Normal);
-  switch (type) {
-  case HELP:
-    print(INFO, line);
-    print(HELP, line2);
-    break;
-  default:
-    print(type, line);
-    print(INFO, line2);
-    break;
-  }
+}
+
+void TerminalBase::print(PRINT_TYPES type, const char* line, size_t length) {
+  printTypeColor(type);
+  __write(line, length);
+  printColor(Normal);
+}
+
+void TerminalBase::print(PRINT_TYPES type, const __FlashStringHelper* line) {
+  printTypeColor(type);
+  __print(line);
+  printColor(Normal);
+}
+
+// A two part line is printed as "type, INFO", except HELP which is "INFO, HELP".
+static PRINT_TYPES firstType(PRINT_TYPES type) {
+  return (type == HELP) ? INFO : type;
+}
+
+static PRINT_TYPES secondType(PRINT_TYPES type) {
+  return (type == HELP) ? HELP : INFO;
+}
+
+void TerminalBase::print(PRINT_TYPES type, String line, String line2) {
+  printTypeColor(type);
+  print(firstType(type), line);
+  print(secondType(type), line2);
+}
+
+void TerminalBase::print(PRINT_TYPES type, const char* line, const char* line2) {
+  printTypeColor(type);
+  print(firstType(type), line);
+  print(secondType(type), line2);
+}
+
+void TerminalBase::print(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2) {
+  printTypeColor(type);
+  print(firstType(type), line);
+  print(secondType(type), line2);
 }
 #endif
 
-void Terminal::println() {
-  __println(String(""));
+void TerminalBase::println() {
+  if (recordOpen) {
+    recordOpen = false;
+    if (outputMode == OUTPUT_JSON)
+      __write("\"}", 2);
+    else
+      __write("\"", 1);
+  }
+  __write("\r\n", 2);
 }
 
 #ifdef TERMINAL_LOGGING
-void Terminal::println(PRINT_TYPES type, String line) {
+void TerminalBase::println(PRINT_TYPES type, String line) {
+  printHeader(type);
+  print(type, line);
+  println();
+}
+
+void TerminalBase::println(PRINT_TYPES type, const char* line) {
   printHeader(type);
   print(type, line);
   println();
 }
 
-void Terminal::println(PRINT_TYPES type, String line, String line2) {
+void TerminalBase::println(PRINT_TYPES type, const char* line, size_t length) {
+  printHeader(type);
+  print(type, line, length);
+  println();
+}
+
+void TerminalBase::println(PRINT_TYPES type, const __FlashStringHelper* line) {
+  printHeader(type);
+  print(type, line);
+  println();
+}
+
+void TerminalBase::println(PRINT_TYPES type, String line, String line2) {
+  printHeader(type);
+  print(type, line, line2);
+  println();
+}
+
+void TerminalBase::println(PRINT_TYPES type, const char* line, const char* line2) {
+  printHeader(type);
+  print(type, line, line2);
+  println();
+}
+
+void TerminalBase::println(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2) {
   printHeader(type);
   print(type, line, line2);
   println();
@@ -158,120 +512,263 @@ void Terminal::println(PRINT_TYPES type, String line, String line2) {
 #endif
 
 #ifdef TERMINAL_HEX_STRING
-static String hexByteString(unsigned char value) {
-  String string = "";
-  if (value < 16) string += "0";
-  string += String(value, HEX);
-  return string;
-}
-
-static const char* printBuffer(unsigned char* buffer, unsigned long length) {
-  static unsigned char* pBuffer;
-  static unsigned long bufferIndex;
-  static unsigned long bufferLength;
-  static String string;
-  string = "";
-  unsigned long loop;
-  if (buffer != nullptr) {
-    pBuffer = buffer;
-    bufferIndex = 0;
-    bufferLength = length;
-  }
-  if (bufferIndex >= bufferLength) return nullptr;
-  string += hexByteString(bufferIndex >> 24 & 0xFF);
-  string += hexByteString(bufferIndex >> 16 & 0xFF);
-  string += hexByteString(bufferIndex >> 8 & 0xFF);
-  string += hexByteString(bufferIndex & 0xFF);
-  string += ": ";
-  unsigned long remaining = bufferLength - bufferIndex;
-  loop = (remaining < 16) ? remaining : 16;
-  loop += bufferIndex;
-  for (; bufferIndex < loop; bufferIndex++) { string += hexByteString(pBuffer[bufferIndex]) + " "; }
-  return string.c_str();
-}
-
-void Terminal::hexdump(unsigned char* buffer, unsigned long length) {
-  char* string = (char*) printBuffer(buffer, length);
-  while (string != nullptr) {
+void TerminalBase::hexdump(const unsigned char* buffer, unsigned long length, unsigned int options) {
+  TerminalUtility::HexDump dump(buffer, length, options);
+  char row[HEXDUMP_ROW_SIZE];
+  unsigned int rowLength;
+  while ((rowLength = dump.next(row)) > 0) {
 #ifdef TERMINAL_LOGGING
-    println(TRACE, String(string));
+    println(TRACE, row, rowLength);
 #else
-    println(String(string));
+    println(row, rowLength);
 #endif
-    string = (char*) printBuffer(nullptr, 0);
   }
 }
 #endif
 
-void Terminal::loop() {
-  ReadLineReturn ret;
-  ret = readline();
+void TerminalBase::loop() {
+  if (inputStream == nullptr) {
+    flush();
+    return;
+  }
+#ifdef TERMINAL_TASKS
+  if (runTask()) {
+    flush();
+    return;
+  }
+#endif
+  // Take everything that is waiting, up to the byte and time budgets, so one busy
+  // stream cannot starve the other terminals serviced from the same loop.
+  unsigned long start = millis();
+  unsigned int processed = 0;
+  while ((processed < inputBudget) && (inputStream != nullptr)) {
+    if (inputIndex >= inputLength) {
+      int available = inputStream->available();
+      if (available <= 0) break;
+      size_t length = (size_t) available;
+      if (length > sizeof(inputChunk)) length = sizeof(inputChunk);
+      if (length > inputBudget - processed) length = inputBudget - processed;
+      inputIndex = 0;
+      inputLength = (unsigned char) inputStream->readBytes(inputChunk, length);
+      if (inputLength == 0) break;
+    }
+    processed += inputLength - inputIndex;
+
+    // A command may detach the stream, the rest of the chunk is then dropped, or start a
+    // task, the rest of the chunk then waits for the task to finish
+    while ((inputIndex < inputLength) && (inputStream != nullptr)) {
+      if (readline(inputChunk[inputIndex++]) == ERROR_NO_CMD_FOUND) unrecognizedCommand();
+#ifdef TERMINAL_TASKS
+      if (taskRunning()) break;
+#endif
+    }
+    if (inputStream == nullptr) inputLength = 0;
+#ifdef TERMINAL_TASKS
+    if (taskRunning()) break;
+#endif
+    if ((timeBudget > 0) && ((millis() - start) >= timeBudget)) break;
+  }
+  if (escapeDecoder.active()) {
+    TerminalUtility::ESCAPE_KEY key = escapeDecoder.poll(millis());
+    if (key != TerminalUtility::KEY_NONE) escapeKey(key);
+  }
+  redraw();
+  flush();
+}
 
-  if (ret == ERROR_NO_CMD_FOUND) {
+#ifdef TERMINAL_TASKS
+void TerminalBase::startTask(TaskFunction function, long value, void* data, TaskAbortFunction abort) {
+  task.function = function;
+  task.abort = abort;
+  task.wake = millis();
+  task.state = 0;
+  task.value = value;
+  task.data = data;
+}
+
+void TerminalBase::abortTask() {
+  if (!taskRunning()) return;
+  task.function = nullptr;
+  if (task.abort != nullptr) task.abort(this, &task);
+  if (outputMode == OUTPUT_TEXT) {
+    __print("^C");
     println();
+  }
+  prompt();
+}
+
+// Looks for a Ctrl-C in the input held back while a task runs, then in what the stream has.
+// The held input is kept in inputChunk for after the task. Once that is full the rest waits in
+// the stream, and only its next byte is looked at. Input typed before the Ctrl-C is discarded
+// with it, as a tty does on an interrupt.
+bool TerminalBase::readInterrupt() {
+  if (inputIndex > 0) {
+    memmove(inputChunk, &inputChunk[inputIndex], inputLength - inputIndex);
+    inputLength -= inputIndex;
+    inputIndex = 0;
+  }
+  char* found = (char*) memchr(inputChunk, CTRL_C_CHAR, inputLength);
+  if (found != nullptr) {
+    inputIndex = found - inputChunk + 1;
+    return true;
+  }
+  while ((inputLength < sizeof(inputChunk)) && (inputStream->available() > 0)) {
+    int c = inputStream->read();
+    if (c < 0) break;
+    if (c == CTRL_C_CHAR) {
+      inputLength = 0;
+      return true;
+    }
+    inputChunk[inputLength++] = (char) c;
+  }
+  if ((inputLength < sizeof(inputChunk)) || (inputStream->peek() != CTRL_C_CHAR)) return false;
+  inputStream->read();
+  inputLength = 0;
+  return true;
+}
+
+// Resumes the running task when its wake time has passed. Returns true while a task is
+// running, input is then held back except for a Ctrl-C, which aborts the task.
+bool TerminalBase::runTask() {
+  if (!taskRunning()) return false;
+  if (readInterrupt()) {
+    abortTask();
+    return false;
+  }
+  if ((long) (millis() - task.wake) >= 0) {
+    if (task.function(this, &task) == TASK_DONE) task.function = nullptr;
+  }
+  return taskRunning();
+}
+#endif
+
+void TerminalBase::unrecognizedCommand() {
+  if (outputMode == OUTPUT_TEXT) println();
 #ifdef TERMINAL_LOGGING
-    char line[80];
-    memset(line, 0, sizeof(line));
-    strncpy(line, "Unrecognized command: ", sizeof(line));
+  printHeader(ERROR);
+  print(ERROR, F("Unrecognized command: "));
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-    strncat(line, lastCmd(), (sizeof(line) - strlen(line)));
+  print(ERROR, lastCmd());
 #endif
-    println(ERROR, line);
-    println(INFO, "Enter \'?\' or \'help\' for a list of commands.");
+  println();
+  println(INFO, F("Enter \'?\' or \'help\' for a list of commands."));
 #else
-    print("Unrecognized command: ");
+  print(F("Unrecognized command: "));
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-    println(lastCmd());
+  println(lastCmd());
 #endif
-    println("Enter \'?\' or \'help\' for a list of commands.");
+  println(F("Enter \'?\' or \'help\' for a list of commands."));
 #endif
-    prompt();
+  prompt();
+}
+
+// Every character of token is a delimiter, looked up in one bit of a 256 bit set
+void TerminalBase::setTokenizer(String token) {
+  memset(delimiters, 0, sizeof(delimiters));
+  for (unsigned int i = 0; i < token.length(); i++) {
+    unsigned char c = token[i];
+    delimiters[c >> 3] |= (1 << (c & 0x07));
   }
 }
 
-void Terminal::setTokenizer(String token) {
-  memset(tokenizer, 0, MAX_INPUT_LINE);
-  strncpy(tokenizer, token.c_str(), MAX_INPUT_LINE - 1);
+String TerminalBase::getTokenizer() {
+  String token;
+  for (unsigned int c = 1; c < 256; c++)
+    if (isDelimiter((char) c)) token += (char) c;
+  return token;
 }
 
-char* Terminal::readParameter() {
-  return strtok_r(NULL, tokenizer, &parameterParseSave);
+// Splits parameterParsing in place. Runs of delimiters separate arguments, quotes (" or ') keep
+// delimiters inside an argument, and a backslash takes the next character as it is, or as a
+// newline, tab or carriage return for n, t and r. Arguments past TERMINAL_MAX_ARGUMENTS are dropped.
+void TerminalBase::tokenize() {
+  char* read = parameterParsing;
+  char* write = parameterParsing; // Never ahead of read, quotes and backslashes only remove characters
+  argc = 0;
+  argIndex = 1;
+  while (*read != '\0') {
+    if (isDelimiter(*read)) {
+      read++;
+      continue;
+    }
+    char* argument = write;
+    char quote = '\0';
+    while ((*read != '\0') && ((quote != '\0') || !isDelimiter(*read))) {
+      char c = *read++;
+      if ((c == '\\') && (*read != '\0')) {
+        c = *read++;
+        *write++ = (c == 'n') ? '\n' : (c == 't') ? '\t' : (c == 'r') ? '\r' : c;
+      } else if ((quote != '\0') && (c == quote))
+        quote = '\0';
+      else if ((quote == '\0') && ((c == '"') || (c == '\'')))
+        quote = c;
+      else
+        *write++ = c;
+    }
+    if (*read != '\0') read++;
+    *write++ = '\0';
+    if (argc < TERMINAL_MAX_ARGUMENTS) argv[argc++] = argument;
+  }
 }
 
-void Terminal::invalidParameter() {
-  println();
+// Arguments after the command name, in order, then nullptr. getArgv reads any of them.
+char* TerminalBase::readParameter() {
+  return (argIndex < argc) ? argv[argIndex++] : nullptr;
+}
+
+// The parameters readParameter has not returned yet, checked against specs in one pass. When
+// they do not match, invalidParameter is reported and the prompt printed, so the command returns.
+bool TerminalBase::readParameters(const ParamSpec* specs, unsigned int count, ParamValue* values) {
+  unsigned int first = (argIndex < argc) ? argIndex : argc;
+  argIndex = argc;
+  if (parseParameters(specs, count, values, &argv[first], argc - first)) return true;
+  invalidParameter();
+  prompt();
+  return false;
+}
+
+void TerminalBase::invalidParameter() {
+  if (outputMode == OUTPUT_TEXT) println();
 #ifdef TERMINAL_LOGGING
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-  if (terminalCommandPtr)
-    println(ERROR, "Unrecognized parameter: " + terminalCommandPtr->getParameter(lastCmdIndex) + ": ");
-  else
-    println(ERROR, "No Command Processor.");
-  println(WARNING, "Command: " + String(lastCmd()));
+  if (terminalCommandPtr) {
+    printHeader(ERROR);
+    print(ERROR, F("Unrecognized parameter: "));
+    print(ERROR, terminalCommandPtr->getParameter(lastCmdIndex));
+    print(ERROR, F(": "));
+    println();
+  } else
+    println(ERROR, F("No Command Processor."));
+  printHeader(WARNING);
+  print(WARNING, F("Command: "));
+  print(WARNING, lastCmd());
+  println();
 #endif
-  println(INFO, "Enter \'?\' or \'help\' for a list of commands.");
+  println(INFO, F("Enter \'?\' or \'help\' for a list of commands."));
 #else
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-  if (terminalCommandPtr)
-    println("Unrecognized parameter: " + terminalCommandPtr->getParameter(lastCmdIndex) + ": ");
-  else
-#ifdef TERMINAL_LOGGING
-    println(ERROR, "No Command Processor.");
-#else
-    println("No Command Processor.");
-#endif
-  println("Command: " + String(lastCmd()));
+  if (terminalCommandPtr) {
+    print(F("Unrecognized parameter: "));
+    print(terminalCommandPtr->getParameter(lastCmdIndex));
+    println(F(": "));
+  } else
+    println(F("No Command Processor."));
+  print(F("Command: "));
+  println(lastCmd());
 #else
-  println("Unrecognized parameter");
+  println(F("Unrecognized parameter"));
 #endif
-  println("Enter \'?\' or \'help\' for a list of commands.");
+  println(F("Enter \'?\' or \'help\' for a list of commands."));
 #endif
 }
 
-void Terminal::configure(OutputInterface* terminal) {
+void TerminalBase::configure(OutputInterface* terminal) {
   setEcho(terminal->getEcho());
   setPrompt(terminal->getPrompt());
+  setOutputMode(terminal->getOutputMode());
+  setBackpressure(terminal->getBackpressure());
   setPromptString(terminal->getPromptString());
-  setTokenizer(String(terminal->getTokenizer()));
+  setTokenizer(terminal->getTokenizer());
 #ifdef TERMINAL_COLORS
   setColor(terminal->getColor());
 #endif
@@ -280,27 +777,55 @@ void Terminal::configure(OutputInterface* terminal) {
 #endif
 }
 
-void Terminal::setup() {
+void TerminalBase::configure(const TerminalSettings& settings) {
+  setEcho(settings.echo);
+  setPrompt(settings.prompt);
+  setOutputMode(settings.outputMode);
+  if (settings.promptString != nullptr) setPromptString(settings.promptString);
+  if (settings.tokenizer != nullptr) setTokenizer(settings.tokenizer);
+#ifdef TERMINAL_COLORS
+  setColor(settings.color);
+#endif
+#ifdef TERMINAL_BANNER
+  setBannerFunction(settings.bannerFunction);
+#endif
+}
+
+void TerminalBase::setup() {
   cmdBuffer.clearBuffer();
-  memset(parameterParsing, 0, MAX_INPUT_LINE);
+  memset(parameterParsing, 0, lineLength);
+  argc = 0;
+  escapeDecoder.reset();
+  redrawPending = false;
+  inputIndex = 0;
+  inputLength = 0;
+#ifdef TERMINAL_TASKS
+  task.function = nullptr;
+#endif
+  screenValid = false;
+#ifdef TERMINAL_OUTPUT_BACKLOG
+  roomReported = false;
+  markDropped = false;
+#endif
+#ifdef TERMINAL_COLORS
+  colorWanted = Normal;
+  colorShown = Normal;
+#endif
 }
 
-ReadLineReturn Terminal::callFunction() {
+ReadLineReturn TerminalBase::callFunction() {
   ReadLineReturn functionCalled = NO_PROCESSING;
   if (cmdBuffer.getCommandLength() > 0) {
-    char* cmdName;
     functionCalled = ERROR_NO_CMD_FOUND;
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-    if (lastBuffer->size() >= HISTORY_BUFFER) { lastBuffer->pop(); }
-    lastBuffer->push(cmdBuffer.getCommand());
-    historyIndex = lastBuffer->size();
+    history.push(cmdBuffer.getCommand(), cmdBuffer.getCommandLength());
+    historyIndex = history.size();
 #endif
-    memset(parameterParsing, 0, MAX_INPUT_LINE);
-    memcpy(parameterParsing, cmdBuffer.getCommand(), MAX_INPUT_LINE);
+    memcpy(parameterParsing, cmdBuffer.getCommand(), lineLength);
     cmdBuffer.clearBuffer();
-    cmdName = strtok_r(parameterParsing, tokenizer, &parameterParseSave);
+    tokenize();
     if (terminalCommandPtr) {
-      int cmdIndex = terminalCommandPtr->findCmd(String(cmdName));
+      int cmdIndex = (argc > 0) ? terminalCommandPtr->findCmd(argv[0]) : -1;
       if (cmdIndex != -1) {
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
         lastCmdIndex = cmdIndex;
@@ -318,96 +843,79 @@ ReadLineReturn Terminal::callFunction() {
   return functionCalled;
 }
 
-bool Terminal::readCharAvailable(unsigned int numberOfChars, unsigned int timeout) {
-  bool available = false;
-  unsigned int availableChar = inputStream->available();
-  if (timeout > 0) {
-    uint32_t start = millis();
-    while ((!available) && ((millis() - start) < timeout)) {
-      availableChar = inputStream->available();
-      available = availableChar >= numberOfChars;
-    }
-  } else {
-    available = availableChar >= numberOfChars;
-  }
-  return available;
-}
-
-ReadLineReturn Terminal::readline() {
-  if (inputStream == nullptr) return NO_PROCESSING;
-
-  char readChar[5];
-  if (!readCharAvailable(1)) return NO_PROCESSING;
-
-  inputStream->readBytes(&readChar[0], 1);
-  char c = readChar[0];
-
-  if (c == HT_CHAR) {
+ReadLineReturn TerminalBase::readline(char c) {
+  if (escapeDecoder.active()) {
+    // Bytes of an escape sequence, which may have started in an earlier chunk
+    TerminalUtility::ESCAPE_KEY key = escapeDecoder.decode(c, millis());
+    if (key == TerminalUtility::KEY_REPROCESS) return readline(c); // The decoder is back in GROUND
+    if (key != TerminalUtility::KEY_NONE) escapeKey(key);
+  } else if (c == HT_CHAR) {
 #ifdef TERMINAL_TAB
-    if (echo) tab();
+    redraw();
+    if (echo && (featureCode->tab != nullptr)) (this->*featureCode->tab)();
 #endif
   } else if (isPrintable(c)) {
-    if (cmdBuffer.addCharacter(c) && echo) { printCommandLine(); }
+    if (cmdBuffer.addCharacter(c) && echo) redrawPending = true;
   } else if (c == CR_CHAR || (c == NL_CHAR && cmdBuffer.getCommandLength() > 0)) {
+    redraw();
     if (echo) println();
     return callFunction();
   } else if (c == DEL_CHAR || c == BS_CHAR) {
     cmdBuffer.deleteCharacter();
-    if (echo) printCommandLine();
+    if (echo) redrawPending = true;
+#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_EDITING
+  } else if ((featureCode->editKey != nullptr) && (this->*featureCode->editKey)(c)) {
+#endif
   } else if (c == ESC_CHAR && echo) {
-    // Wait for the next two bytes of the escape sequence
-    if (!readCharAvailable(2, 12)) { // We didn't get the rest of the Escape char sequence
-      cmdBuffer.deleteCharacter();
-      return NO_PROCESSING;
-    }
-    inputStream->readBytes(&readChar[1], 2);
+    escapeDecoder.decode(c, millis());
+  }
 
+  return NO_PROCESSING;
+}
+
+// History is browsed with the arrows by every terminal, the other keys are editing
+void TerminalBase::escapeKey(TerminalUtility::ESCAPE_KEY key) {
+  switch (key) {
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-    if (readChar[1] == VT100_UP_ARROW[1] && readChar[2] == VT100_UP_ARROW[2]) {
-      upArrow();
-    } else if (readChar[1] == VT100_DOWN_ARROW[1] && readChar[2] == VT100_DOWN_ARROW[2]) {
-      downArrow();
-#else
-    if (0) {
+  case TerminalUtility::KEY_UP: upArrow(); break;
+  case TerminalUtility::KEY_DOWN: downArrow(); break;
 #endif
-#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_EDITING
-    } else if (readChar[1] == VT100_RIGHT_ARROW[1] && readChar[2] == VT100_RIGHT_ARROW[2]) {
-      rightArrow();
-    } else if (readChar[1] == VT100_LEFT_ARROW[1] && readChar[2] == VT100_LEFT_ARROW[2]) {
-      leftArrow();
-#else
-    } else if (0) {
-#endif
-    } else {
-      // Optional: handle unknown escape sequences here
-      // __print("ESC " + String(readChar[1]) + String(readChar[2]));
-      // while (inputStream->available()) {
-      //   inputStream->readBytes(&readChar[0], 1);
-      //   __print(String(readChar[0]));
-      // }
-      // println();
-    }
+  default:
+    if (featureCode->editEscape != nullptr) (this->*featureCode->editEscape)(key);
+    break;
   }
+}
 
-  return NO_PROCESSING;
+// Echo for a chunk of input is drawn once, just before anything else is printed, and only
+// the difference from what is already on screen is sent when nothing else was printed since.
+void TerminalBase::redraw() {
+  if (redrawPending) {
+    redrawPending = false;
+    if (screenValid)
+      updateCommandLine();
+    else
+      printCommandLine();
+  }
 }
 
-void Terminal::setContext(unsigned int i, void* ptr) {
+void TerminalBase::setContext(unsigned int i, void* ptr) {
   if (i >= MAX_CONTEXT) return;
   contextArray[i] = ptr;
 };
-void* Terminal::getContext(unsigned int i) {
+void* TerminalBase::getContext(unsigned int i) {
   if (i >= MAX_CONTEXT) return nullptr;
   return contextArray[i];
 };
 
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-char* Terminal::lastCmd() {
-  return (char*) lastBuffer->get(lastBuffer->size() - 1);
+// Without history only the command name is left, in parameterParsing
+char* TerminalBase::lastCmd() {
+  if (history.empty()) return parameterParsing;
+  return (char*) history.newest();
 }
 #endif
 
-void Terminal::clearScreen() {
+void TerminalBase::clearScreen() {
 #ifdef TERMINAL_COLORS
   if (usecolor) {
     __print(VT100_CLEAR_SCREEN);
@@ -417,16 +925,16 @@ void Terminal::clearScreen() {
   if (0) {
 #endif
 #ifdef TERMINAL_LOGGING
-    println(ERROR, "Command not implemented for this terminal.");
+    println(ERROR, F("Command not implemented for this terminal."));
 #else
-    println("Command not implemented for this terminal.");
+    println(F("Command not implemented for this terminal."));
 #endif
   }
 }
 
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-void Terminal::clearHistory() {
-  lastBuffer->clear();
+void TerminalBase::clearHistory() {
+  history.clear();
   historyIndex = 0;
 }
 #endif
@@ -3,103 +3,205 @@
 #include "utility/characterCodes.h"
 
 namespace TerminalLibrary {
-void Terminal::clearCommandLine() {
+void TerminalBase::clearCommandLine() {
   __print(VT100_ERASE_LINE);
   __print(VT100_SET_CURSOR_BEGIN);
-  prompt();
+  printPrompt(); // No flush, the redraw leaves as one write
+  screenLength = 0;
+  screenCursor = 0;
 }
 
-void Terminal::printCommandLine() {
+// Full redraw, used when the screen no longer matches the last line drawn.
+void TerminalBase::printCommandLine() {
   clearCommandLine();
-  __print(cmdBuffer.getCommand());
-  int backupCursor = cmdBuffer.getCommandLength() - cmdBuffer.getIndex();
-  for (int i = 0; i < backupCursor; i++) __print(VT100_LEFT_CURSOR);
+  updateCommandLine();
 }
 
-#ifdef TERMINAL_TAB
-void Terminal::tab() {
-  String blankLine = "                         ";
-  if (echo && (cmdBuffer.getCommandLength() > 0)) {
-    // Find number of commands that match
-    int cmdCount = 0;
-    int cmdIndex = -1;
-    String buffer = cmdBuffer.getCommand();
-    for (int i = 0; i < TERM_CMD->getCmdCount(); i++) {
-      String readCommand = TERM_CMD->getCmd(i);
-      readCommand = readCommand.substring(0, cmdBuffer.getCommandLength());
-      if (readCommand.compareTo(buffer) == 0) {
-        cmdCount++;
-        cmdIndex = i;
+// Writes part of the command line as it is stored, either side of the gap
+void TerminalBase::writeCommandLine(unsigned long index, unsigned long count) {
+  while (count > 0) {
+    unsigned long part = count;
+    const char* text = cmdBuffer.span(index, &part);
+    __write(text, part);
+    index += part;
+    count -= part;
+  }
+}
+
+// Moves the screen cursor between two columns of the command line with one CUB/CUF sequence.
+void TerminalBase::cursorColumn(unsigned long from, unsigned long to) {
+  if (from == to) return;
+  char sequence[16];
+  int length;
+  if (from > to)
+    length = snprintf(sequence, sizeof(sequence), "\x1B[%luD", from - to);
+  else
+    length = snprintf(sequence, sizeof(sequence), "\x1B[%luC", to - from);
+  __write(sequence, length);
+}
+
+// Brings the screen from screenLine to the command buffer by rewriting only what changed
+// between the common prefix and suffix, inserting or deleting characters (ICH/DCH) so the
+// unchanged tail does not have to be sent again. The line is read in place, the gap stays where
+// the cursor is so the next keystroke does not have to move the tail.
+void TerminalBase::updateCommandLine() {
+  unsigned long length = cmdBuffer.getCommandLength();
+  unsigned long cursor = cmdBuffer.getIndex();
+  unsigned long shortest = (length < screenLength) ? length : screenLength;
+  unsigned long prefix = 0;
+  while (prefix < shortest && cmdBuffer.characterAt(prefix) == screenLine[prefix]) prefix++;
+  unsigned long suffix = 0;
+  while (suffix < shortest - prefix &&
+         cmdBuffer.characterAt(length - 1 - suffix) == screenLine[screenLength - 1 - suffix])
+    suffix++;
+  unsigned long removed = screenLength - prefix - suffix;
+  unsigned long inserted = length - prefix - suffix;
+  unsigned long column = screenCursor;
+
+  if (removed > 0 || inserted > 0) {
+    char sequence[16];
+    cursorColumn(column, prefix);
+    if (suffix == 0) {
+      // Nothing to keep on the right, write the new end and erase what is left of the old one
+      writeCommandLine(prefix, inserted);
+      if (removed > inserted) __print("\x1B[K");
+    } else {
+      unsigned long overwrite = (removed < inserted) ? removed : inserted;
+      writeCommandLine(prefix, overwrite);
+      if (inserted > removed) {
+        __write(sequence, snprintf(sequence, sizeof(sequence), "\x1B[%lu@", inserted - removed));
+        writeCommandLine(prefix + overwrite, inserted - overwrite);
+      } else if (removed > inserted) {
+        __write(sequence, snprintf(sequence, sizeof(sequence), "\x1B[%luP", removed - inserted));
       }
     }
-    // If single command then replace command with found one.
-    if (cmdCount == 1) {
-      String readCommand = TERM_CMD->getCmd(cmdIndex);
-      readCommand = readCommand.substring(cmdBuffer.getCommandLength());
-      __print(readCommand);
-      cmdBuffer.clearBuffer();
-      cmdBuffer.setCommand((char*) TERM_CMD->getCmd(cmdIndex).c_str());
-      __print(" ");
-      cmdBuffer.addCharacter(' ');
-    } else { // If multiple commands, print commands and replace prompt.
-      cmdCount = 0;
-      for (int i = 0; i < TERM_CMD->getCmdCount(); i++) {
-        String readCommand = TERM_CMD->getCmd(i);
-        readCommand = readCommand.substring(0, cmdBuffer.getCommandLength());
-        if (readCommand.compareTo(buffer) == 0) {
-          if (cmdCount % 3 == 0) println();
-          __print(TERM_CMD->getCmd(i));
-          String line = blankLine.substring(0, 16 - TERM_CMD->getCmd(i).length());
-          __print(line);
-          cmdCount++;
-        }
-      }
-      println();
-      prompt();
-      __print(cmdBuffer.getCommand());
+    column = prefix + inserted;
+  }
+  cursorColumn(column, cursor);
+
+  cmdBuffer.copy(0, length, screenLine);
+  screenLength = length;
+  screenCursor = cursor;
+  screenValid = true;
+}
+
+#ifdef TERMINAL_TAB
+void TerminalBase::tab() {
+  static const char blankLine[] = "                ";
+  const size_t columnWidth = sizeof(blankLine) - 1;
+  if (!echo || (terminalCommandPtr == nullptr)) return;
+  unsigned long length = cmdBuffer.getCommandLength();
+  if (length == 0) return;
+
+  // One lookup returns every command that starts with the buffer, and how far they agree.
+  SortedCursor cursor;
+  size_t common = 0;
+  // Looked up in a copy, parameterParsing is free until a command runs, so the gap stays put
+  cmdBuffer.copy(0, length, parameterParsing);
+  int cmdCount = terminalCommandPtr->findPrefix(parameterParsing, length, &cursor, &common);
+  if (cmdCount == 0) return;
+
+  // Names are copied into parameterParsing, which is free until a command runs, as they may be in flash
+  char* name = parameterParsing;
+  if (cmdCount == 1 || common > length) {
+    // Complete a single command with a trailing space, or complete up to the shared prefix.
+    terminalCommandPtr->getCmdName(terminalCommandPtr->nextSorted(&cursor), name, lineLength);
+    cmdBuffer.setCommand(name, common);
+    if (cmdCount == 1) cmdBuffer.addCharacter(' ');
+    redrawPending = true;
+  } else { // If multiple commands share nothing more, print commands and replace prompt.
+    for (int i = 0; i < cmdCount; i++) {
+      int index = terminalCommandPtr->nextSorted(&cursor);
+      size_t nameLength = terminalCommandPtr->getCmdName(index, name, lineLength);
+      if (nameLength >= lineLength) nameLength = lineLength - 1;
+      if (i % 3 == 0) println();
+      __write(name, nameLength);
+      if (nameLength < columnWidth) __write(blankLine, columnWidth - nameLength);
     }
+    println();
+    prompt();
+    redrawPending = true;
   }
 }
 #endif
 
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-void Terminal::upArrow() {
-  char tempBuffer[MAX_INPUT_LINE];
-  memset(tempBuffer, 0, MAX_INPUT_LINE);
-  if (lastBuffer->size() > 0) {
-    clearCommandLine();
-    cmdBuffer.clearBuffer();
+void TerminalBase::upArrow() {
+  if (history.size() > 0) {
     if (historyIndex > 0) historyIndex--;
-    lastBuffer->get(historyIndex, tempBuffer);
-    cmdBuffer.setCommand(tempBuffer);
-    __print(cmdBuffer.getCommand());
+    cmdBuffer.setCommand(history.get(historyIndex), history.length(historyIndex));
+    redrawPending = echo;
   }
 }
 
-void Terminal::downArrow() {
-  char tempBuffer[MAX_INPUT_LINE];
-  memset(tempBuffer, 0, MAX_INPUT_LINE);
-  if (lastBuffer->size() > 0) {
-    clearCommandLine();
-    cmdBuffer.clearBuffer();
-    if (historyIndex < (lastBuffer->size() - 1)) historyIndex++;
-    lastBuffer->get(historyIndex, tempBuffer);
-    cmdBuffer.setCommand(tempBuffer);
-    __print(cmdBuffer.getCommand());
+void TerminalBase::downArrow() {
+  if (history.size() > 0) {
+    if (historyIndex < (history.size() - 1)) historyIndex++;
+    cmdBuffer.setCommand(history.get(historyIndex), history.length(historyIndex));
+    redrawPending = echo;
   }
 }
 #endif
 
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_EDITING
-void Terminal::rightArrow() {
-  if (echo) {
-    if (cmdBuffer.forwardIndex()) __print(VT100_RIGHT_CURSOR);
+// Cursor moves and edits only mark the line, redraw() sends the difference once.
+void TerminalBase::rightArrow() {
+  if (cmdBuffer.forwardIndex() && echo) redrawPending = true;
+}
+
+void TerminalBase::leftArrow() {
+  if (cmdBuffer.backIndex() && echo) redrawPending = true;
+}
+
+void TerminalBase::homeKey() {
+  if (cmdBuffer.home() && echo) redrawPending = true;
+}
+
+void TerminalBase::endKey() {
+  if (cmdBuffer.end() && echo) redrawPending = true;
+}
+
+void TerminalBase::wordLeft() {
+  if (cmdBuffer.wordLeft() && echo) redrawPending = true;
+}
+
+void TerminalBase::wordRight() {
+  if (cmdBuffer.wordRight() && echo) redrawPending = true;
+}
+
+void TerminalBase::deleteKey() {
+  if (cmdBuffer.deleteForward() && echo) redrawPending = true;
+}
+
+// Emacs style control keys, returns false when c is not one of them.
+bool TerminalBase::editKey(char c) {
+  switch (c) {
+  case CTRL_A_CHAR: homeKey(); break;
+  case CTRL_E_CHAR: endKey(); break;
+  case CTRL_K_CHAR:
+    if (cmdBuffer.killToEnd() && echo) redrawPending = true;
+    break;
+  case CTRL_U_CHAR:
+    if (cmdBuffer.killToStart() && echo) redrawPending = true;
+    break;
+  case CTRL_W_CHAR:
+    if (cmdBuffer.deleteWord() && echo) redrawPending = true;
+    break;
+  default: return false;
   }
+  return true;
 }
 
-void Terminal::leftArrow() {
-  if (echo) {
-    if (cmdBuffer.backIndex()) __print(VT100_LEFT_CURSOR);
+void TerminalBase::editEscape(TerminalUtility::ESCAPE_KEY key) {
+  switch (key) {
+  case TerminalUtility::KEY_RIGHT: rightArrow(); break;
+  case TerminalUtility::KEY_LEFT: leftArrow(); break;
+  case TerminalUtility::KEY_HOME: homeKey(); break;
+  case TerminalUtility::KEY_END: endKey(); break;
+  case TerminalUtility::KEY_DELETE: deleteKey(); break;
+  case TerminalUtility::KEY_WORD_LEFT: wordLeft(); break;
+  case TerminalUtility::KEY_WORD_RIGHT: wordRight(); break;
+  default: break; // Unmapped keys and a lone ESC are ignored
   }
 }
 #endif
@@ -9,13 +9,36 @@
 */
 #include <Terminal.h> // OutputInterface, COLOR, PRINT_TYPES (optional), Arduino String
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdio.h>
+#if defined(TERMINAL_ENABLE_DEBUG) &&                                                                                  \
+    (defined(TERMINAL_USE_SPINLOCK) || (defined(TERMINAL_DEBUG_ASYNC) && !defined(ARDUINO_ARCH_AVR)))
+#include <atomic>
+#endif
 
 #ifndef TERMINAL_MAX_SINKS
 #define TERMINAL_MAX_SINKS 8
 #endif
 
+#ifndef TERMINAL_DEBUG_QUEUE
+#define TERMINAL_DEBUG_QUEUE 16 // Records held by the async queue, a power of two
+#endif
+#ifndef TERMINAL_DEBUG_RECORD
+#define TERMINAL_DEBUG_RECORD 48 // Bytes of text kept per record, longer lines are cut
+#endif
+
+#ifndef TERMINAL_MAX_BINARY_SINKS
+#define TERMINAL_MAX_BINARY_SINKS 2
+#endif
+#ifndef TERMINAL_DEBUG_FRAME
+#define TERMINAL_DEBUG_FRAME 64 // Largest tokenized record, header included
+#endif
+#define TERMINAL_DEBUG_FRAME_START 0x1E
+
 namespace TerminalLibrary {
+// What an async Debug does when a record arrives and the queue is full
+typedef enum { DROP_NEWEST, DROP_OLDEST } DEBUG_OVERFLOW;
+
 // ============================================================================
 // Build-time switch
 // ============================================================================
@@ -34,25 +57,46 @@ public:
   }
   inline void registerOutput(OutputInterface*) {}
   inline void deregisterOutput(OutputInterface*) {}
+  inline void registerBinaryOutput(Print*) {}
+  inline void deregisterBinaryOutput(Print*) {}
   inline void print(const String&) {}
+  inline void print(const char*) {}
+  inline void print(const __FlashStringHelper*) {}
   inline void print(COLOR, const String&) {}
+  inline void print(COLOR, const char*) {}
+  inline void print(COLOR, const __FlashStringHelper*) {}
   inline void println() {}
   inline void println(const String&) {}
+  inline void println(const char*) {}
+  inline void println(const __FlashStringHelper*) {}
   inline void printf(const char*, ...) {}
   inline void printf(COLOR, const char*, ...) {}
 #ifdef TERMINAL_LOGGING
   inline void print(PRINT_TYPES, const String&) {}
+  inline void print(PRINT_TYPES, const char*) {}
+  inline void print(PRINT_TYPES, const __FlashStringHelper*) {}
   inline void print(PRINT_TYPES, const String&, const String&) {}
+  inline void print(PRINT_TYPES, const char*, const char*) {}
+  inline void print(PRINT_TYPES, const __FlashStringHelper*, const __FlashStringHelper*) {}
   inline void println(PRINT_TYPES, const String&) {}
+  inline void println(PRINT_TYPES, const char*) {}
+  inline void println(PRINT_TYPES, const __FlashStringHelper*) {}
   inline void println(PRINT_TYPES, const String&, const String&) {}
+  inline void println(PRINT_TYPES, const char*, const char*) {}
+  inline void println(PRINT_TYPES, const __FlashStringHelper*, const __FlashStringHelper*) {}
 #endif
 #ifdef TERMINAL_HEX_STRING
-  inline void hexdump(unsigned char*, unsigned long) {}
+  inline void hexdump(const unsigned char*, unsigned long, unsigned int = HEXDUMP_PLAIN) {}
 #endif
 #ifdef TERMINAL_BANNER
   inline void banner() {}
 #endif
   inline void prompt() {}
+  inline void flush() {}
+  inline void drain(unsigned int = 0) {}
+  inline void setOverflowPolicy(DEBUG_OVERFLOW) {}
+  inline DEBUG_OVERFLOW getOverflowPolicy() { return DROP_NEWEST; }
+  inline unsigned long getDropped() { return 0; }
 
 private:
   Debug() = default;
@@ -65,10 +109,23 @@ private:
  * Locking:
  * - Default: disable interrupts during tiny critical sections (Arduino-safe)
  * - Optional: define TERMINAL_USE_SPINLOCK to use std::atomic_flag spinlock
+ *
+ * Async (TERMINAL_DEBUG_ASYNC):
+ * - print calls copy their text into a bounded lock-free queue and return
+ * - drain(), called from loop(), sends the queued records to the sinks
+ * - a full queue drops the newest or the oldest record, see setOverflowPolicy
+ *
+ * Tokenized (TERMINAL_DEBUG_TOKENIZED):
+ * - DBG_PRINTF sends binary sinks a frame holding the address of the format
+ *   string and the raw argument bytes, nothing is formatted for them
+ * - text sinks still receive the formatted line, it is only formatted when
+ *   a text sink is registered
+ * - extras/terminal_log_decode.py rebuilds the text using the firmware ELF
+ *
+ * Frame: 0x1E, payload length, format address (4 bytes, little endian), then
+ * per argument a tag and its bytes: 'i'/'u' 4 bytes, 'q'/'Q' 8 bytes,
+ * 'f' float, 'd' double, 'c' 1 byte, 'p' 4 bytes, 's' length byte + text.
  */
-#if defined(TERMINAL_USE_SPINLOCK)
-#include <atomic>
-#endif
 
 class Debug {
 public:
@@ -110,57 +167,99 @@ public:
     }
   }
 
-  // --------------------------------------------------------------------------
-  // Plain printing
-  // --------------------------------------------------------------------------
-  inline void print(const String& line) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-#ifdef TERMINAL_LOGGING
-      if (w) w->print(TRACE, line);
-#else
-      if (w) w->print(line);
-#endif
+#if defined(TERMINAL_DEBUG_TOKENIZED)
+  // Register a binary sink for tokenized records (no ownership). Ignores if full.
+  inline void registerBinaryOutput(Print* out) {
+    if (!out) return;
+    LockGuard g(*this);
+    for (size_t i = 0; i < binary_count_; ++i) {
+      if (binary_[i] == out) return;
     }
+    if (binary_count_ < TERMINAL_MAX_BINARY_SINKS) { binary_[binary_count_++] = out; }
   }
 
-  // Print with color to all sinks
-  inline void print(COLOR color, const String& line) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->print(color, line);
+  inline void deregisterBinaryOutput(Print* out) {
+    if (!out) return;
+    LockGuard g(*this);
+    for (size_t i = 0; i < binary_count_; /*increment inside*/) {
+      if (binary_[i] == out) {
+        binary_[i] = binary_[binary_count_ - 1];
+        --binary_count_;
+      } else {
+        ++i;
+      }
     }
   }
 
-  // println() blank line
-  inline void println() {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->println();
+  // DBG_PRINTF in tokenized mode. fmt must be a string literal, its address is the token.
+  template <typename... Args> inline void printfToken(const char* fmt, Args... args) {
+    if (!fmt) return;
+    if (sinks_count_ > 0) printf(fmt, args...);
+    if (binary_count_ == 0) return;
+    TokenFrame frame;
+    frame.put((uint32_t) (uintptr_t) fmt);
+    int expand[] = {0, (encode_(frame, args), 0)...};
+    (void) expand;
+    if (frame.overflow) {
+      ++tokens_dropped_;
+      return;
+    }
+    frame.data[1] = (unsigned char) (frame.length - 2);
+    Print* sinks[TERMINAL_MAX_BINARY_SINKS];
+    size_t count;
+    {
+      LockGuard g(*this);
+      count = binary_count_;
+      for (size_t i = 0; i < count; ++i) sinks[i] = binary_[i];
     }
+    for (size_t i = 0; i < count; ++i) sinks[i]->write(frame.data, frame.length);
   }
 
-  // println(line) — supports both TERMINAL_LOGGING (no println(String)) and no-logging
-  inline void println(const String& line) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (!w) continue;
-#ifdef TERMINAL_LOGGING
-      w->print(TRACE, line);
-      w->println();
+  inline unsigned long getTokensDropped() { return tokens_dropped_; }
 #else
-      w->println(line);
+  inline void registerBinaryOutput(Print*) {}
+  inline void deregisterBinaryOutput(Print*) {}
+#endif
+
+  // --------------------------------------------------------------------------
+  // Plain printing
+  // --------------------------------------------------------------------------
+  inline void print(const String& line) { printTrace_(line); }
+  inline void print(const char* line) { printTrace_(line); }
+  inline void print(const __FlashStringHelper* line) { printTrace_(line); }
+
+  // Print with color to all sinks
+  inline void print(COLOR color, const String& line) { printColor_(color, line); }
+  inline void print(COLOR color, const char* line) { printColor_(color, line); }
+  inline void print(COLOR color, const __FlashStringHelper* line) { printColor_(color, line); }
+
+  // println() blank line
+  inline void println() {
+#if defined(TERMINAL_DEBUG_ASYNC)
+    push_(RECORD_NEWLINE, 0, "");
+#else
+    forEachSink_([](OutputInterface* w) { w->println(); });
 #endif
-    }
   }
 
+  // println(line) — supports both TERMINAL_LOGGING (no println(String)) and no-logging
+  inline void println(const String& line) { printlnTrace_(line); }
+  inline void println(const char* line) { printlnTrace_(line); }
+  inline void println(const __FlashStringHelper* line) { printlnTrace_(line); }
+
   // --------------------------------------------------------------------------
   // printf-style helpers
   // --------------------------------------------------------------------------
+#if defined(TERMINAL_DEBUG_ASYNC)
+  // Only the address of fmt and the raw argument bytes are queued, drain() does the formatting.
+  // fmt must be a string literal, or otherwise outlive the record.
+  template <typename... Args> inline void printf(const char* fmt, Args... args) {
+    pushFormat_(RECORD_FORMAT, 0, fmt, args...);
+  }
+  template <typename... Args> inline void printf(COLOR color, const char* fmt, Args... args) {
+    pushFormat_(RECORD_FORMAT_COLOR, color, fmt, args...);
+  }
+#else
   inline void printf(const char* fmt, ...) {
     if (!fmt) return;
     char small[128];
@@ -171,9 +270,8 @@ public:
     int n = ::vsnprintf(small, sizeof(small), fmt, copy);
     va_end(copy);
     if (n >= 0 && (size_t) n < sizeof(small)) {
-      String s(small);
       va_end(args);
-      print(s);
+      print((const char*) small);
       return;
     }
     int needed = (n < 0) ? 256 : (n + 1);
@@ -185,9 +283,8 @@ public:
     }
     ::vsnprintf(buf, (size_t) needed, fmt, args);
     va_end(args);
-    String s(buf);
+    print((const char*) buf);
     delete[] buf;
-    print(s);
   }
 
   inline void printf(COLOR color, const char* fmt, ...) {
@@ -200,9 +297,8 @@ public:
     int n = ::vsnprintf(small, sizeof(small), fmt, copy);
     va_end(copy);
     if (n >= 0 && (size_t) n < sizeof(small)) {
-      String s(small);
       va_end(args);
-      print(color, s);
+      print(color, (const char*) small);
       return;
     }
     int needed = (n < 0) ? 256 : (n + 1);
@@ -213,75 +309,97 @@ public:
     }
     ::vsnprintf(buf, (size_t) needed, fmt, args);
     va_end(args);
-    String s(buf);
+    print(color, (const char*) buf);
     delete[] buf;
-    print(color, s);
   }
+#endif
 
   // --------------------------------------------------------------------------
   // Optional pass-throughs per your interface toggles
   // --------------------------------------------------------------------------
 #ifdef TERMINAL_LOGGING
-  inline void print(PRINT_TYPES type, const String& line) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->print(type, line);
-    }
-  }
-  inline void print(PRINT_TYPES type, const String& line, const String& line2) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->print(type, line, line2);
-    }
+  inline void print(PRINT_TYPES type, const String& line) { printType_(type, line); }
+  inline void print(PRINT_TYPES type, const char* line) { printType_(type, line); }
+  inline void print(PRINT_TYPES type, const __FlashStringHelper* line) { printType_(type, line); }
+  inline void print(PRINT_TYPES type, const String& line, const String& line2) { printType_(type, line, line2); }
+  inline void print(PRINT_TYPES type, const char* line, const char* line2) { printType_(type, line, line2); }
+  inline void print(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2) {
+    printType_(type, line, line2);
   }
-  inline void println(PRINT_TYPES type, const String& line) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->println(type, line);
-    }
-  }
-  inline void println(PRINT_TYPES type, const String& line, const String& line2) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->println(type, line, line2);
-    }
+  inline void println(PRINT_TYPES type, const String& line) { printlnType_(type, line); }
+  inline void println(PRINT_TYPES type, const char* line) { printlnType_(type, line); }
+  inline void println(PRINT_TYPES type, const __FlashStringHelper* line) { printlnType_(type, line); }
+  inline void println(PRINT_TYPES type, const String& line, const String& line2) { printlnType_(type, line, line2); }
+  inline void println(PRINT_TYPES type, const char* line, const char* line2) { printlnType_(type, line, line2); }
+  inline void println(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2) {
+    printlnType_(type, line, line2);
   }
 #endif // TERMINAL_LOGGING
 
 #ifdef TERMINAL_HEX_STRING
-  inline void hexdump(unsigned char* buffer, unsigned long length) {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->hexdump(buffer, length);
-    }
+  inline void hexdump(const unsigned char* buffer, unsigned long length, unsigned int options = HEXDUMP_PLAIN) {
+    forEachSink_([&](OutputInterface* w) { w->hexdump(buffer, length, options); });
   }
 #endif // TERMINAL_HEX_STRING
 
 #ifdef TERMINAL_BANNER
   inline void banner() {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->banner();
-    }
+    forEachSink_([](OutputInterface* w) { w->banner(); });
   }
 #endif // TERMINAL_BANNER
 
   inline void prompt() {
-    auto snap = snapshotSinks_();
-    for (size_t i = 0; i < snap.count; ++i) {
-      auto* w = snap.arr[i];
-      if (w) w->prompt();
+    forEachSink_([](OutputInterface* w) { w->prompt(); });
+  }
+
+  inline void flush() {
+    forEachSink_([](OutputInterface* w) { w->flush(); });
+  }
+
+#if defined(TERMINAL_DEBUG_ASYNC)
+  // --------------------------------------------------------------------------
+  // Async queue: print calls only copy their text into a record, call drain()
+  // from loop() to send the records to the sinks.
+  // --------------------------------------------------------------------------
+  inline void drain(unsigned int maxRecords = 0) {
+    RecordData record;
+    unsigned int count = 0;
+    unsigned long dropped = load_(dropped_);
+    if (dropped != reportedDrops_) {
+      char marker[40];
+      snprintf(marker, sizeof(marker), "[%lu debug records dropped]", dropped - reportedDrops_);
+      reportedDrops_ = dropped;
+#ifdef TERMINAL_LOGGING
+      forEachSink_([&](OutputInterface* w) { w->println(WARNING, (const char*) marker); });
+#else
+      forEachSink_([&](OutputInterface* w) { w->println((const char*) marker); });
+#endif
+    }
+    while (((maxRecords == 0) || (count < maxRecords)) && pop_(&record)) {
+      dispatch_(record);
+      count++;
     }
+    if (count > 0) flush();
   }
 
+  inline void setOverflowPolicy(DEBUG_OVERFLOW policy) { overflow_ = policy; }
+  inline DEBUG_OVERFLOW getOverflowPolicy() { return overflow_; }
+  inline unsigned long getDropped() { return load_(dropped_); }
+#else
+  inline void drain(unsigned int = 0) {}
+  inline void setOverflowPolicy(DEBUG_OVERFLOW) {}
+  inline DEBUG_OVERFLOW getOverflowPolicy() { return DROP_NEWEST; }
+  inline unsigned long getDropped() { return 0; }
+#endif
+
 private:
+#if defined(TERMINAL_DEBUG_ASYNC)
+  Debug() {
+    for (size_t i = 0; i < TERMINAL_DEBUG_QUEUE; ++i) store_(ring_[i].sequence, i);
+  }
+#else
   Debug() = default;
+#endif
 
   // ---- Locking primitives ----
 #if defined(TERMINAL_USE_SPINLOCK)
@@ -318,6 +436,524 @@ private:
     return s;
   }
 
+  // Call fn on every registered sink, without holding the lock
+  template <typename Fn> inline void forEachSink_(Fn fn) {
+    auto snap = snapshotSinks_();
+    for (size_t i = 0; i < snap.count; ++i) {
+      auto* w = snap.arr[i];
+      if (w) fn(w);
+    }
+  }
+
+#if defined(TERMINAL_DEBUG_ASYNC)
+  // ---- Bounded MPMC ring (D. Vyukov): every slot carries a sequence number ----
+  // A slot is free for the producer at position p when its sequence is p, and holds a
+  // record for the consumer when it is p + 1. Producers only copy text, never format or
+  // wait on a sink, and with DROP_OLDEST a producer may retire the oldest record itself.
+  static_assert((TERMINAL_DEBUG_QUEUE & (TERMINAL_DEBUG_QUEUE - 1)) == 0, "TERMINAL_DEBUG_QUEUE must be a power of two");
+  static_assert(TERMINAL_DEBUG_RECORD < 256, "TERMINAL_DEBUG_RECORD must be less than 256");
+  static_assert(TERMINAL_DEBUG_RECORD > sizeof(const char*), "TERMINAL_DEBUG_RECORD must hold a format address");
+
+  enum RecordKind : unsigned char {
+    RECORD_PRINT,
+    RECORD_PRINTLN,
+    RECORD_NEWLINE,
+    RECORD_COLOR,
+    RECORD_TYPE,
+    RECORD_TYPE_LN,
+    RECORD_TYPE2,   // Two part line, the second part starts at text + split
+    RECORD_TYPE2_LN,
+    RECORD_FORMAT, // text holds the format address, then split bytes of arguments as in a TokenFrame
+    RECORD_FORMAT_COLOR
+  };
+
+  struct RecordData {
+    unsigned char kind;
+    unsigned short attr; // COLOR, with its Bold and Palette bits, or PRINT_TYPES
+    unsigned char split; // Length of the first part
+    char text[TERMINAL_DEBUG_RECORD];
+  };
+
+#if defined(ARDUINO_ARCH_AVR)
+  // One core: the index updates are made atomic by masking interrupts, and restoring SREG
+  // keeps this safe to call from an ISR.
+  typedef volatile size_t Atomic;
+  typedef volatile unsigned long AtomicCount;
+  struct IrqGuard {
+    uint8_t sreg;
+    IrqGuard() : sreg(SREG) { cli(); }
+    ~IrqGuard() { SREG = sreg; }
+  };
+  template <typename T> static inline T load_(volatile T& a) {
+    IrqGuard g;
+    return a;
+  }
+  template <typename T> static inline void store_(volatile T& a, T value) {
+    IrqGuard g;
+    a = value;
+  }
+  static inline bool cas_(Atomic& a, size_t& expected, size_t desired) {
+    IrqGuard g;
+    if (a == expected) {
+      a = desired;
+      return true;
+    }
+    expected = a;
+    return false;
+  }
+  static inline void increment_(AtomicCount& a) {
+    IrqGuard g;
+    a = a + 1;
+  }
+#else
+  typedef std::atomic<size_t> Atomic;
+  typedef std::atomic<unsigned long> AtomicCount;
+  template <typename T> static inline T load_(std::atomic<T>& a) { return a.load(std::memory_order_acquire); }
+  template <typename T> static inline void store_(std::atomic<T>& a, T value) { a.store(value, std::memory_order_release); }
+  static inline bool cas_(Atomic& a, size_t& expected, size_t desired) {
+    return a.compare_exchange_weak(expected, desired, std::memory_order_acq_rel, std::memory_order_relaxed);
+  }
+  static inline void increment_(AtomicCount& a) { a.fetch_add(1, std::memory_order_relaxed); }
+#endif
+
+  struct Record {
+    Atomic sequence;
+    RecordData data;
+  };
+
+  // Claims the slot at the tail for a producer, nullptr when the record is dropped.
+  inline Record* claim_(size_t* position) {
+    size_t pos = load_(enqueue_);
+    for (;;) {
+      Record* r = &ring_[pos & (TERMINAL_DEBUG_QUEUE - 1)];
+      ptrdiff_t diff = (ptrdiff_t) (load_(r->sequence) - pos);
+      if (diff == 0) {
+        if (cas_(enqueue_, pos, pos + 1)) {
+          *position = pos;
+          return r;
+        }
+      } else if (diff < 0) { // Full
+        if ((overflow_ == DROP_OLDEST) && retire_(nullptr)) {
+          increment_(dropped_);
+          pos = load_(enqueue_);
+          continue;
+        }
+        increment_(dropped_);
+        return nullptr;
+      } else {
+        pos = load_(enqueue_);
+      }
+    }
+  }
+
+  inline void publish_(Record* r, size_t position) { store_(r->sequence, position + 1); }
+
+  // Takes the record at the head, copied to out when out is given. False when empty.
+  inline bool retire_(RecordData* out) {
+    size_t pos = load_(dequeue_);
+    for (;;) {
+      Record* r = &ring_[pos & (TERMINAL_DEBUG_QUEUE - 1)];
+      ptrdiff_t diff = (ptrdiff_t) (load_(r->sequence) - (pos + 1));
+      if (diff == 0) {
+        if (cas_(dequeue_, pos, pos + 1)) {
+          if (out) *out = r->data;
+          store_(r->sequence, pos + TERMINAL_DEBUG_QUEUE);
+          return true;
+        }
+      } else if (diff < 0) { // Empty, or the oldest record is still being written
+        return false;
+      } else {
+        pos = load_(dequeue_);
+      }
+    }
+  }
+
+  inline bool pop_(RecordData* out) { return retire_(out); }
+
+  static inline size_t copyText_(char* text, size_t capacity, const char* line) {
+    size_t n = 0;
+    if (line)
+      while ((n < capacity) && line[n]) {
+        text[n] = line[n];
+        ++n;
+      }
+    return n;
+  }
+
+  static inline size_t copyText_(char* text, size_t capacity, const String& line) {
+    return copyText_(text, capacity, line.c_str());
+  }
+
+  static inline size_t copyText_(char* text, size_t capacity, const __FlashStringHelper* line) {
+    const char* flash = (const char*) line;
+    size_t n = 0;
+    if (flash)
+      while (n < capacity) {
+        char c = (char) pgm_read_byte(flash + n);
+        if (!c) break;
+        text[n++] = c;
+      }
+    return n;
+  }
+
+  template <typename Text> inline void push_(RecordKind kind, unsigned short attr, const Text& line) {
+    size_t position;
+    Record* r = claim_(&position);
+    if (!r) return;
+    size_t n = copyText_(r->data.text, TERMINAL_DEBUG_RECORD - 1, line);
+    r->data.text[n] = 0;
+    r->data.kind = kind;
+    r->data.attr = attr;
+    r->data.split = (unsigned char) n;
+    publish_(r, position);
+  }
+
+  template <typename Text>
+  inline void push_(RecordKind kind, unsigned short attr, const Text& line, const Text& line2) {
+    size_t position;
+    Record* r = claim_(&position);
+    if (!r) return;
+    size_t n = copyText_(r->data.text, TERMINAL_DEBUG_RECORD / 2 - 1, line);
+    r->data.text[n++] = 0;
+    r->data.split = (unsigned char) n;
+    n += copyText_(&r->data.text[n], TERMINAL_DEBUG_RECORD - 1 - n, line2);
+    r->data.text[n] = 0;
+    r->data.kind = kind;
+    r->data.attr = attr;
+    publish_(r, position);
+  }
+
+  // printf arguments are encoded as they are, arguments that do not fit the record are cut off
+  // with the rest of the line.
+  template <typename... Args>
+  inline void pushFormat_(RecordKind kind, unsigned short attr, const char* fmt, Args... args) {
+    if (!fmt) return;
+    size_t position;
+    Record* r = claim_(&position);
+    if (!r) return;
+    memcpy(r->data.text, &fmt, sizeof(fmt));
+    ArgBuffer buffer((unsigned char*) r->data.text, TERMINAL_DEBUG_RECORD, sizeof(fmt));
+    int expand[] = {0, (encode_(buffer, args), 0)...};
+    (void) expand;
+    r->data.kind = kind;
+    r->data.attr = attr;
+    r->data.split = (unsigned char) buffer.length;
+    publish_(r, position);
+  }
+
+  // Rebuilds a printf line from a RECORD_FORMAT, handing one conversion at a time to snprintf with
+  // the size taken from the argument's tag rather than from the format.
+  static inline size_t format_(const RecordData& record, char* out, size_t capacity) {
+    const char* fmt;
+    memcpy(&fmt, record.text, sizeof(fmt));
+    const unsigned char* arg = (const unsigned char*) record.text + sizeof(fmt);
+    const unsigned char* end = (const unsigned char*) record.text + record.split;
+    size_t n = 0;
+    while (*fmt && (n < capacity - 1)) {
+      if (*fmt != '%') {
+        out[n++] = *fmt++;
+        continue;
+      }
+      if (fmt[1] == '%') {
+        out[n++] = '%';
+        fmt += 2;
+        continue;
+      }
+      char spec[16];
+      size_t s = 0;
+      spec[s++] = *fmt++;
+      while (*fmt && strchr("-+ #0123456789.", *fmt) && (s < sizeof(spec) - 4)) spec[s++] = *fmt++;
+      while (*fmt && strchr("hlLqjzt", *fmt)) fmt++;
+      char conversion = *fmt;
+      if (!conversion || (arg >= end)) break; // The arguments after this did not fit the record
+      fmt++;
+      long long integer = 0;
+      double number = 0;
+      char text[TERMINAL_DEBUG_RECORD] = "?";
+      char tag = (char) *arg++;
+      bool wide = (tag == 'q') || (tag == 'Q');
+      switch (tag) {
+      case 'i': integer = readArg_<int32_t>(arg); break;
+      case 'u':
+      case 'p': integer = readArg_<uint32_t>(arg); break;
+      case 'q': integer = readArg_<int64_t>(arg); break;
+      case 'Q': integer = (long long) readArg_<uint64_t>(arg); break;
+      case 'f': number = readArg_<float>(arg); break;
+      case 'd': number = readArg_<double>(arg); break;
+      case 'c': integer = (char) *arg++; break;
+      case 's': {
+        size_t length = *arg++;
+        if (arg + length > end) length = end - arg;
+        memcpy(text, arg, length);
+        text[length] = '\0';
+        arg += length;
+        break;
+      }
+      default: arg = end + 1; break;
+      }
+      if (arg > end) break;
+      if ((tag == 'f') || (tag == 'd'))
+        integer = (long long) number;
+      else
+        number = (double) integer;
+      int written;
+      switch (conversion) {
+      case 'd':
+      case 'i':
+      case 'o':
+      case 'u':
+      case 'x':
+      case 'X':
+        spec[s++] = 'l';
+        if (wide) spec[s++] = 'l';
+        spec[s++] = conversion;
+        spec[s] = '\0';
+        if (wide)
+          written = snprintf(&out[n], capacity - n, spec, integer);
+        else
+          written = snprintf(&out[n], capacity - n, spec, (long) integer);
+        break;
+      case 'c':
+        spec[s++] = 'c';
+        spec[s] = '\0';
+        written = snprintf(&out[n], capacity - n, spec, (int) integer);
+        break;
+      case 's':
+        spec[s++] = 's';
+        spec[s] = '\0';
+        written = snprintf(&out[n], capacity - n, spec, text);
+        break;
+      case 'p':
+        spec[s++] = 'p';
+        spec[s] = '\0';
+        written = snprintf(&out[n], capacity - n, spec, (void*) (uintptr_t) integer);
+        break;
+      case 'e':
+      case 'E':
+      case 'f':
+      case 'F':
+      case 'g':
+      case 'G':
+      case 'a':
+      case 'A':
+        spec[s++] = conversion;
+        spec[s] = '\0';
+        written = snprintf(&out[n], capacity - n, spec, number);
+        break;
+      default: written = -1; break;
+      }
+      if (written < 0) break;
+      n += ((size_t) written < capacity - 1 - n) ? (size_t) written : capacity - 1 - n;
+    }
+    out[n] = '\0';
+    return n;
+  }
+
+  template <typename T> static inline T readArg_(const unsigned char*& arg) {
+    T value;
+    memcpy(&value, arg, sizeof(value));
+    arg += sizeof(value);
+    return value;
+  }
+
+  inline void dispatch_(const RecordData& record) {
+    const char* text = record.text;
+    size_t length = record.split;
+    switch (record.kind) {
+    case RECORD_PRINT: printTraceNow_(text, length); break;
+    case RECORD_PRINTLN: printlnTraceNow_(text, length); break;
+    case RECORD_NEWLINE: forEachSink_([](OutputInterface* w) { w->println(); }); break;
+    case RECORD_COLOR: forEachSink_([&](OutputInterface* w) { w->print((COLOR) record.attr, text, length); }); break;
+    case RECORD_FORMAT:
+    case RECORD_FORMAT_COLOR: {
+      char line[128];
+      size_t n = format_(record, line, sizeof(line));
+      if (record.kind == RECORD_FORMAT)
+        printTraceNow_(line, n);
+      else
+        forEachSink_([&](OutputInterface* w) { w->print((COLOR) record.attr, (const char*) line, n); });
+      break;
+    }
+#ifdef TERMINAL_LOGGING
+    case RECORD_TYPE:
+      forEachSink_([&](OutputInterface* w) { w->print((PRINT_TYPES) record.attr, text, length); });
+      break;
+    case RECORD_TYPE_LN:
+      forEachSink_([&](OutputInterface* w) { w->println((PRINT_TYPES) record.attr, text, length); });
+      break;
+    case RECORD_TYPE2:
+      forEachSink_([&](OutputInterface* w) { w->print((PRINT_TYPES) record.attr, text, &text[length]); });
+      break;
+    case RECORD_TYPE2_LN:
+      forEachSink_([&](OutputInterface* w) { w->println((PRINT_TYPES) record.attr, text, &text[length]); });
+      break;
+#endif
+    default: break;
+    }
+  }
+
+  inline void printTraceNow_(const char* text, size_t length) {
+#ifdef TERMINAL_LOGGING
+    forEachSink_([&](OutputInterface* w) { w->print(TRACE, text, length); });
+#else
+    forEachSink_([&](OutputInterface* w) { w->print(text, length); });
+#endif
+  }
+
+  inline void printlnTraceNow_(const char* text, size_t length) {
+#ifdef TERMINAL_LOGGING
+    forEachSink_([&](OutputInterface* w) {
+      w->print(TRACE, text, length);
+      w->println();
+    });
+#else
+    forEachSink_([&](OutputInterface* w) { w->println(text, length); });
+#endif
+  }
+
+  // Fan-out bodies shared by the String, const char* and F() overloads queue a record
+  template <typename Text> inline void printTrace_(const Text& line) { push_(RECORD_PRINT, 0, line); }
+  template <typename Text> inline void printlnTrace_(const Text& line) { push_(RECORD_PRINTLN, 0, line); }
+  template <typename Text> inline void printColor_(COLOR color, const Text& line) {
+    push_(RECORD_COLOR, color, line);
+  }
+#ifdef TERMINAL_LOGGING
+  template <typename Text> inline void printType_(PRINT_TYPES type, const Text& line) {
+    push_(RECORD_TYPE, type, line);
+  }
+  template <typename Text> inline void printType_(PRINT_TYPES type, const Text& line, const Text& line2) {
+    push_(RECORD_TYPE2, type, line, line2);
+  }
+  template <typename Text> inline void printlnType_(PRINT_TYPES type, const Text& line) {
+    push_(RECORD_TYPE_LN, type, line);
+  }
+  template <typename Text> inline void printlnType_(PRINT_TYPES type, const Text& line, const Text& line2) {
+    push_(RECORD_TYPE2_LN, type, line, line2);
+  }
+#endif
+
+  Record ring_[TERMINAL_DEBUG_QUEUE];
+  Atomic enqueue_{0};
+  Atomic dequeue_{0};
+  AtomicCount dropped_{0};
+  unsigned long reportedDrops_ = 0; // Only used by drain()
+  DEBUG_OVERFLOW overflow_ = DROP_NEWEST;
+#else
+  // Fan-out bodies shared by the String, const char* and F() overloads
+  template <typename Text> inline void printTrace_(const Text& line) {
+#ifdef TERMINAL_LOGGING
+    forEachSink_([&](OutputInterface* w) { w->print(TRACE, line); });
+#else
+    forEachSink_([&](OutputInterface* w) { w->print(line); });
+#endif
+  }
+
+  template <typename Text> inline void printlnTrace_(const Text& line) {
+#ifdef TERMINAL_LOGGING
+    forEachSink_([&](OutputInterface* w) {
+      w->print(TRACE, line);
+      w->println();
+    });
+#else
+    forEachSink_([&](OutputInterface* w) { w->println(line); });
+#endif
+  }
+
+  template <typename Text> inline void printColor_(COLOR color, const Text& line) {
+    forEachSink_([&](OutputInterface* w) { w->print(color, line); });
+  }
+
+#ifdef TERMINAL_LOGGING
+  template <typename Text> inline void printType_(PRINT_TYPES type, const Text& line) {
+    forEachSink_([&](OutputInterface* w) { w->print(type, line); });
+  }
+
+  template <typename Text> inline void printType_(PRINT_TYPES type, const Text& line, const Text& line2) {
+    forEachSink_([&](OutputInterface* w) { w->print(type, line, line2); });
+  }
+
+  template <typename Text> inline void printlnType_(PRINT_TYPES type, const Text& line) {
+    forEachSink_([&](OutputInterface* w) { w->println(type, line); });
+  }
+
+  template <typename Text> inline void printlnType_(PRINT_TYPES type, const Text& line, const Text& line2) {
+    forEachSink_([&](OutputInterface* w) { w->println(type, line, line2); });
+  }
+#endif
+#endif // TERMINAL_DEBUG_ASYNC
+
+#if defined(TERMINAL_DEBUG_ASYNC) || defined(TERMINAL_DEBUG_TOKENIZED)
+  // ---- Raw printf arguments, for async records and tokenized frames ----
+  struct ArgBuffer {
+    unsigned char* data;
+    size_t capacity;
+    size_t length;
+    bool overflow = false;
+    ArgBuffer(unsigned char* __data, size_t __capacity, size_t __length)
+        : data(__data), capacity(__capacity), length(__length) {}
+    inline bool room(size_t n) {
+      if (length + n > capacity) overflow = true;
+      return !overflow;
+    }
+    inline void put(const void* bytes, size_t n) {
+      if (!room(n)) return;
+      memcpy(&data[length], bytes, n);
+      length += n;
+    }
+    template <typename T> inline void put(T value) { put(&value, sizeof(value)); }
+    template <typename T> inline void tagged(char tag, T value) {
+      if (!room(1 + sizeof(value))) return;
+      data[length++] = (unsigned char) tag;
+      put(value);
+    }
+  };
+
+  // Arguments are stored little endian as the MCU holds them, widened to 4 or 8 bytes
+  static inline void encode_(ArgBuffer& f, char v) { f.tagged('c', v); }
+  static inline void encode_(ArgBuffer& f, signed char v) { f.tagged('i', (int32_t) v); }
+  static inline void encode_(ArgBuffer& f, unsigned char v) { f.tagged('u', (uint32_t) v); }
+  static inline void encode_(ArgBuffer& f, bool v) { f.tagged('u', (uint32_t) v); }
+  static inline void encode_(ArgBuffer& f, short v) { f.tagged('i', (int32_t) v); }
+  static inline void encode_(ArgBuffer& f, unsigned short v) { f.tagged('u', (uint32_t) v); }
+  static inline void encode_(ArgBuffer& f, int v) { f.tagged('i', (int32_t) v); }
+  static inline void encode_(ArgBuffer& f, unsigned int v) { f.tagged('u', (uint32_t) v); }
+  static inline void encode_(ArgBuffer& f, long v) { f.tagged('i', (int32_t) v); }
+  static inline void encode_(ArgBuffer& f, unsigned long v) { f.tagged('u', (uint32_t) v); }
+  static inline void encode_(ArgBuffer& f, long long v) { f.tagged('q', (int64_t) v); }
+  static inline void encode_(ArgBuffer& f, unsigned long long v) { f.tagged('Q', (uint64_t) v); }
+  static inline void encode_(ArgBuffer& f, float v) { f.tagged('f', v); }
+  static inline void encode_(ArgBuffer& f, double v) {
+    if (sizeof(double) == sizeof(float))
+      f.tagged('f', (float) v);
+    else
+      f.tagged('d', v);
+  }
+  static inline void encode_(ArgBuffer& f, const char* v) {
+    if (!v) v = "(null)";
+    size_t n = strlen(v);
+    if (n > 255) n = 255;
+    if (!f.room(2)) return;
+    if (n > f.capacity - f.length - 2) n = f.capacity - f.length - 2; // Cut to fit
+    f.data[f.length++] = 's';
+    f.data[f.length++] = (unsigned char) n;
+    f.put(v, n);
+  }
+  static inline void encode_(ArgBuffer& f, char* v) { encode_(f, (const char*) v); }
+  template <typename T> static inline void encode_(ArgBuffer& f, T* v) { f.tagged('p', (uint32_t) (uintptr_t) v); }
+#endif
+
+#if defined(TERMINAL_DEBUG_TOKENIZED)
+  // ---- Tokenized records ----
+  struct TokenFrame : ArgBuffer {
+    unsigned char bytes[TERMINAL_DEBUG_FRAME] = {TERMINAL_DEBUG_FRAME_START, 0};
+    TokenFrame() : ArgBuffer(bytes, TERMINAL_DEBUG_FRAME, 2) {}
+  };
+
+  Print* binary_[TERMINAL_MAX_BINARY_SINKS]{};
+  size_t binary_count_{0};
+  unsigned long tokens_dropped_{0};
+#endif
+
 private:
   // Non-owning pointers; ensure deregister before sink destruction.
   OutputInterface* sinks_[TERMINAL_MAX_SINKS]{};
@@ -337,8 +973,13 @@ private:
   do { ::TerminalLibrary::Debug::instance().println(); } while (0)
 #define DBG_PRINTLNS(s)                                                                                                \
   do { ::TerminalLibrary::Debug::instance().println((s)); } while (0)
+#if defined(TERMINAL_DEBUG_TOKENIZED)
+#define DBG_PRINTF(fmt, ...)                                                                                           \
+  do { ::TerminalLibrary::Debug::instance().printfToken((fmt), ##__VA_ARGS__); } while (0)
+#else
 #define DBG_PRINTF(fmt, ...)                                                                                           \
   do { ::TerminalLibrary::Debug::instance().printf((fmt), ##__VA_ARGS__); } while (0)
+#endif
 #define DBG_PRINTFC(c, fmt, ...)                                                                                       \
   do { ::TerminalLibrary::Debug::instance().printf((c), (fmt), ##__VA_ARGS__); } while (0)
 #define DBG_REGISTER(o)                                                                                                \
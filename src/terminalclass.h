@@ -10,7 +10,9 @@
 #include "output_interface.h"
 #include "termcmd.h"
 #include "utility/commandBuffer.h"
-#include "utility/queue.h"
+#include "utility/escapeDecoder.h"
+#include "utility/history.h"
+#include "utility/ring.h"
 
 #include <Stream.h>
 
@@ -18,26 +20,80 @@ namespace TerminalLibrary {
 
 typedef enum { NO_PROCESSING, HELP_FUNCTION_CALLED, EMPTY_STRING, ERROR_NO_CMD_FOUND } ReadLineReturn;
 
-class Terminal : public OutputInterface {
-public:
-  Terminal(Stream* __stream) : inputStream(__stream), outputStream(__stream) { initialize(); };
-  Terminal(Stream* __inputStream, Stream* __outputStream) : inputStream(__inputStream), outputStream(__outputStream) {
-    initialize();
+// Features a terminal instance may leave out, on top of the ones removed in features.h
+typedef enum {
+  TERMINAL_FEATURE_COLORS = 0x01,
+  TERMINAL_FEATURE_TAB = 0x02,
+  TERMINAL_FEATURE_EDITING = 0x04,
+  TERMINAL_FEATURE_ALL = 0x07
+} TERMINAL_FEATURES;
+
+// Settings for a terminal, a few bytes where configure from another Terminal needs a whole one.
+// The strings are not copied and must stay valid, nullptr leaves the terminal's own.
+struct TerminalSettings {
+  bool echo = true;
+  bool prompt = true;
+  bool color = false;
+  OUTPUT_MODE outputMode = OUTPUT_TEXT;
+  const char* promptString = nullptr;
+  const char* tokenizer = nullptr;
+  void (*bannerFunction)(OutputInterface*) = nullptr;
+};
+
+// The terminal itself, without storage. Line, parameter, screen and history buffers are carved
+// from memory owned by BasicTerminal, so every size of terminal shares this one copy of the code.
+class TerminalBase : public OutputInterface {
+  typedef void (TerminalBase::*Action)();
+  typedef bool (TerminalBase::*KeyAction)(char);
+  typedef void (TerminalBase::*EscapeAction)(TerminalUtility::ESCAPE_KEY);
+  // The code of the TERMINAL_FEATURES, nullptr for a feature left out. Only tables of features
+  // some terminal has take the address of their code, so the rest is never linked in.
+  struct FeatureCode {
+    Action tab;
+    KeyAction editKey;
+    EscapeAction editEscape;
+    Action applyColor;
+  };
+  template <bool On> struct TabCode {
+    static constexpr Action get() { return nullptr; };
+  };
+  template <bool On> struct EditCode {
+    static constexpr KeyAction key() { return nullptr; };
+    static constexpr EscapeAction escape() { return nullptr; };
+  };
+  template <bool On> struct ColorCode {
+    static constexpr Action get() { return nullptr; };
+  };
+
+protected:
+  template <unsigned int Features> struct Code {
+    static const FeatureCode table;
   };
+
+public:
+  // memory holds 3 * lineLength bytes for the line, then historyDepth * lineLength bytes of history
+  TerminalBase(Stream* __inputStream, Stream* __outputStream, char* memory, unsigned int __lineLength,
+               unsigned int __historyDepth, unsigned int __features, const FeatureCode* __featureCode);
+  TerminalBase(const TerminalBase&) = delete;
+  TerminalBase& operator=(const TerminalBase&) = delete;
   void initialize() {
-    memset(parameterParsing, 0, MAX_INPUT_LINE);
-    memset(tokenizer, 0, MAX_INPUT_LINE);
+    memset(parameterParsing, 0, lineLength);
     setTokenizer(" ");
     terminalCommandPtr = TERM_CMD;
   };
   void configure(OutputInterface* terminal);
+  void configure(const TerminalSettings& settings);
   void setTerminalCommand(TerminalCommand* __terminalCommandPtr) { terminalCommandPtr = __terminalCommandPtr; };
   TerminalCommand* getTerminalCommand() { return terminalCommandPtr; };
   void setStream(Stream* __stream) {
+    flush();
+    resetBacklog();
     inputStream = __stream;
     outputStream = __stream;
   };
   void setStream(Stream* __inputStream, Stream* __outputStream) {
+    flush();
+    resetBacklog();
     inputStream = __inputStream;
     outputStream = __outputStream;
   };
@@ -45,38 +101,88 @@ public:
   Stream* getOutput() { return outputStream; };
   void setup();
   void loop();
+  void setInputBudget(unsigned int __inputBudget) { inputBudget = __inputBudget; };
+  unsigned int getInputBudget() { return inputBudget; };
+  void setTimeBudget(unsigned long __timeBudget) { timeBudget = __timeBudget; };
+  unsigned long getTimeBudget() { return timeBudget; };
   void println();
 #ifdef TERMINAL_COLORS
   void print(COLOR color, String line);
+  void print(COLOR color, const char* line);
+  void print(COLOR color, const char* line, size_t length);
+  void print(COLOR color, const __FlashStringHelper* line);
 #else
   inline void print(COLOR color, String line) { __print(line); };
+  inline void print(COLOR color, const char* line) { __print(line); };
+  inline void print(COLOR color, const char* line, size_t length) { __write(line, length); };
+  inline void print(COLOR color, const __FlashStringHelper* line) { __print(line); };
 #endif
 #ifdef TERMINAL_LOGGING
   void printHeader(PRINT_TYPES type);
   void print(PRINT_TYPES type, String line);
+  void print(PRINT_TYPES type, const char* line);
+  void print(PRINT_TYPES type, const char* line, size_t length);
+  void print(PRINT_TYPES type, const __FlashStringHelper* line);
   void print(PRINT_TYPES type, String line, String line2);
+  void print(PRINT_TYPES type, const char* line, const char* line2);
+  void print(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2);
   void println(PRINT_TYPES type, String line);
+  void println(PRINT_TYPES type, const char* line);
+  void println(PRINT_TYPES type, const char* line, size_t length);
+  void println(PRINT_TYPES type, const __FlashStringHelper* line);
   void println(PRINT_TYPES type, String line, String line2);
+  void println(PRINT_TYPES type, const char* line, const char* line2);
+  void println(PRINT_TYPES type, const __FlashStringHelper* line, const __FlashStringHelper* line2);
   inline void print(String line) { print(INFO, line); };
+  inline void print(const char* line) { print(INFO, line); };
+  inline void print(const char* line, size_t length) { print(INFO, line, length); };
+  inline void print(const __FlashStringHelper* line) { print(INFO, line); };
   inline void println(String line) { println(INFO, line); };
+  inline void println(const char* line) { println(INFO, line); };
+  inline void println(const char* line, size_t length) { println(INFO, line, length); };
+  inline void println(const __FlashStringHelper* line) { println(INFO, line); };
 #else
   inline void print(String line) { __print(line); };
+  inline void print(const char* line) { __print(line); };
+  inline void print(const char* line, size_t length) { __write(line, length); };
+  inline void print(const __FlashStringHelper* line) { __print(line); };
   inline void println(String line) { __println(line); };
+  inline void println(const char* line) { __println(line); };
+  inline void println(const char* line, size_t length) {
+    __write(line, length);
+    println();
+  };
+  inline void println(const __FlashStringHelper* line) { __println(line); };
 #endif
 #ifdef TERMINAL_HEX_STRING
-  void hexdump(unsigned char* buffer, unsigned long length);
+  void hexdump(const unsigned char* buffer, unsigned long length, unsigned int options = HEXDUMP_PLAIN);
 #endif
   void prompt();
+  void flush();
+  void setFlushPolicy(FLUSH_POLICY __flushPolicy) { flushPolicy = __flushPolicy; };
+  FLUSH_POLICY getFlushPolicy() { return flushPolicy; };
+  void setBackpressure(BACKPRESSURE_POLICY __backpressure) { backpressure = __backpressure; };
+  BACKPRESSURE_POLICY getBackpressure() { return backpressure; };
+  unsigned long getStalls() { return stalls; };
+  unsigned long getDropped() { return dropped; };
+#ifdef TERMINAL_OUTPUT_BACKLOG
+  size_t getBacklog() { return backlog.size(); };
+#endif
   void setTokenizer(String token);
-  char* getTokenizer() { return tokenizer; };
+  String getTokenizer();
   char* readParameter();
+  unsigned int getArgc() { return argc; };
+  char* getArgv(unsigned int index) { return (index < argc) ? argv[index] : nullptr; };
+  bool readParameters(const ParamSpec* specs, unsigned int count, ParamValue* values);
   void invalidParameter();
   void setEcho(bool __echo) { echo = __echo; };
   bool getEcho() { return echo; };
 #ifdef TERMINAL_COLORS
-  void setColor(bool __usecolor) { usecolor = __usecolor; };
+  void setColor(bool __usecolor) { usecolor = __usecolor && (features & TERMINAL_FEATURE_COLORS); };
   bool getColor() { return usecolor; };
 #endif
+  void setOutputMode(OUTPUT_MODE __outputMode) { outputMode = __outputMode; };
+  OUTPUT_MODE getOutputMode() { return outputMode; };
   void setPrompt(bool __useprompt) { useprompt = __useprompt; };
   bool getPrompt() { return useprompt; };
   void setPromptString(String __prompt) { promptString = __prompt; };
@@ -92,12 +198,24 @@ public:
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
   void clearHistory();
 #endif
-  TerminalUtility::Queue* getLastBuffer() { return lastBuffer; };
+  TerminalUtility::History* getHistory() { return &history; };
+  unsigned int getMaxInputLine() { return lineLength; };
+  unsigned int getFeatures() { return features; };
 
   virtual void setContext(unsigned int i, void* ptr) override;
   virtual void* getContext(unsigned int i) override;
 
+#ifdef TERMINAL_TASKS
+  virtual void startTask(TaskFunction function, long value = 0, void* data = nullptr,
+                         TaskAbortFunction abort = nullptr) override;
+  virtual bool taskRunning() override { return task.function != nullptr; };
+  void abortTask();
+#endif
+
 private:
+  const unsigned int lineLength;
+  const unsigned int features;
+  const FeatureCode* const featureCode;
   Stream* inputStream = nullptr;
   Stream* outputStream = nullptr;
   bool echo = true;
@@ -105,6 +223,29 @@ private:
   bool usecolor = false;
 #endif
   bool useprompt = true;
+  OUTPUT_MODE outputMode = OUTPUT_TEXT;
+  bool recordOpen = false; // A log record is being printed in a machine readable mode, its text is escaped
+  FLUSH_POLICY flushPolicy = FLUSH_ON_NEWLINE;
+#ifdef TERMINAL_OUTPUT_BUFFER
+  char outputBuffer[TERMINAL_OUTPUT_BUFFER];
+  size_t outputLength = 0;
+#endif
+  BACKPRESSURE_POLICY backpressure = BACKPRESSURE_BLOCK;
+  unsigned long stalls = 0;  // Writes the stream had no room for
+  unsigned long dropped = 0; // Bytes discarded by the backpressure policy
+#ifdef TERMINAL_OUTPUT_BACKLOG
+  TerminalUtility::Ring<char, TERMINAL_OUTPUT_BACKLOG> backlog;
+  bool roomReported = false; // The stream implements availableForWrite, it has reported room
+  bool markDropped = false;  // Output was dropped, the marker goes out before anything else
+  size_t writeRoom(size_t length);
+  bool drain();
+  void writeBacklog();
+  void dropBacklog();
+  void resetBacklog();
+#else
+  inline void dropBacklog() {};
+  inline void resetBacklog() {};
+#endif
   String promptString = "PROGRAM:\\> ";
   String terminalName = "";
 #ifdef TERMINAL_BANNER
@@ -112,18 +253,47 @@ private:
 #endif
 
 #ifdef TERMINAL_COLORS
-  void printColor(COLOR color);
+  unsigned int colorWanted = Normal; // Set by printColor, sent ahead of the next output
+  unsigned int colorShown = Normal;  // What the stream was last told
+  inline void printColor(COLOR color) { colorWanted = color; };
+  void applyColor();
 #else
   inline void printColor(COLOR color) {};
 #endif
   void __print(String line);
+  void __print(const char* line);
+  void __print(const __FlashStringHelper* line);
   void __print(char character);
+  void __write(const char* buffer, size_t length);
+  void __emit(const char* buffer, size_t length);
+  void send(const char* buffer, size_t length);
+  void sendOutput();
   void __println(String line);
+  void __println(const char* line);
+  void __println(const __FlashStringHelper* line);
   void __println(char character);
+#ifdef TERMINAL_LOGGING
+  void printTypeColor(PRINT_TYPES type);
+  void openRecord(PRINT_TYPES type);
+#endif
 
-  bool readCharAvailable(unsigned int numberOfChars, unsigned int timeout);
-  bool readCharAvailable(unsigned int numberOfChars) { return readCharAvailable(numberOfChars, 0); };
-  ReadLineReturn readline();
+  ReadLineReturn readline(char c);
+  void redraw();
+  void unrecognizedCommand();
+  void escapeKey(TerminalUtility::ESCAPE_KEY key);
+  TerminalUtility::EscapeDecoder escapeDecoder;
+  bool redrawPending = false;
+  // Input read from the stream and not yet processed, it is held while a task runs
+  char inputChunk[TERMINAL_INPUT_CHUNK];
+  unsigned char inputIndex = 0;
+  unsigned char inputLength = 0;
+#ifdef TERMINAL_TASKS
+  TerminalTask task;
+  bool runTask();
+  bool readInterrupt();
+#endif
+  unsigned int inputBudget = TERMINAL_INPUT_BUDGET;
+  unsigned long timeBudget = 0;
   ReadLineReturn callFunction();
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
   char* lastCmd();
@@ -132,12 +302,26 @@ private:
 #endif
 
   TerminalUtility::CommandBuffer cmdBuffer;
-  char parameterParsing[MAX_INPUT_LINE];
-  char* parameterParseSave = nullptr;
-  char tokenizer[MAX_INPUT_LINE];
+  // The command line is split once, when it is run, into arguments that point into parameterParsing
+  char* const parameterParsing;
+  char* argv[TERMINAL_MAX_ARGUMENTS];
+  unsigned char argc = 0;
+  unsigned char argIndex = 0; // Next argument readParameter returns
+  unsigned char delimiters[32]; // One bit for each character, built by setTokenizer
+  bool isDelimiter(char c) { return delimiters[(unsigned char) c >> 3] & (1 << (c & 0x07)); };
+  void tokenize();
 
+  void printPrompt();
   void clearCommandLine();
   void printCommandLine();
+  void updateCommandLine();
+  void cursorColumn(unsigned long from, unsigned long to);
+  void writeCommandLine(unsigned long index, unsigned long count);
+  // What the command line on screen holds after the prompt, any other output invalidates it
+  char* const screenLine;
+  unsigned long screenLength = 0;
+  unsigned long screenCursor = 0;
+  bool screenValid = false;
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
   void upArrow();
   void downArrow();
@@ -145,16 +329,67 @@ private:
 #ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_EDITING
   void rightArrow();
   void leftArrow();
+  void homeKey();
+  void endKey();
+  void deleteKey();
+  void wordLeft();
+  void wordRight();
+  bool editKey(char c);
+  void editEscape(TerminalUtility::ESCAPE_KEY key);
 #endif
 #ifdef TERMINAL_TAB
   void tab();
 #endif
-#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
-  TerminalUtility::Queue* lastBuffer = new TerminalUtility::Queue(HISTORY_BUFFER, MAX_INPUT_LINE);
-#endif
+  TerminalUtility::History history;
   TerminalCommand* terminalCommandPtr = nullptr;
 
   void* contextArray[MAX_CONTEXT] = {nullptr};
 };
+
+#ifdef TERMINAL_TAB
+template <> struct TerminalBase::TabCode<true> {
+  static constexpr Action get() { return &TerminalBase::tab; };
+};
+#endif
+#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_EDITING
+template <> struct TerminalBase::EditCode<true> {
+  static constexpr KeyAction key() { return &TerminalBase::editKey; };
+  static constexpr EscapeAction escape() { return &TerminalBase::editEscape; };
+};
+#endif
+#ifdef TERMINAL_COLORS
+template <> struct TerminalBase::ColorCode<true> {
+  static constexpr Action get() { return &TerminalBase::applyColor; };
+};
+#endif
+template <unsigned int Features>
+const TerminalBase::FeatureCode TerminalBase::Code<Features>::table = {
+    TabCode<(Features & TERMINAL_FEATURE_TAB) != 0>::get(), EditCode<(Features & TERMINAL_FEATURE_EDITING) != 0>::key(),
+    EditCode<(Features & TERMINAL_FEATURE_EDITING) != 0>::escape(),
+    ColorCode<(Features & TERMINAL_FEATURE_COLORS) != 0>::get()};
+
+template <unsigned int LineLength, unsigned int HistoryDepth> struct TerminalStorage {
+  char terminalMemory[(3 + HistoryDepth) * LineLength];
+};
+
+// A terminal with all of its buffers inside the object, no heap is used. LineLength includes
+// the NUL. History gets HistoryDepth * LineLength bytes, which holds many more commands than
+// HistoryDepth as most are short, 0 leaves history out. Features is an OR of TERMINAL_FEATURES,
+// the code of a feature no terminal of the sketch has is left out of the build.
+// The storage is a base class so it exists before TerminalBase is constructed over it.
+template <unsigned int LineLength = MAX_INPUT_LINE, unsigned int HistoryDepth = HISTORY_BUFFER,
+          unsigned int Features = TERMINAL_FEATURE_ALL>
+class BasicTerminal : private TerminalStorage<LineLength, HistoryDepth>, public TerminalBase {
+  static_assert(LineLength > 1, "A terminal line needs room for a character and the NUL");
+
+public:
+  BasicTerminal(Stream* __stream) : BasicTerminal(__stream, __stream) {};
+  BasicTerminal(Stream* __inputStream, Stream* __outputStream)
+      : TerminalBase(__inputStream, __outputStream, this->terminalMemory, LineLength, HistoryDepth, Features,
+                     &Code<Features>::table) {};
+  virtual size_t getMemoryUsage() override { return sizeof(*this); };
+};
+
+typedef BasicTerminal<> Terminal;
 } // namespace TerminalLibrary
 #endif
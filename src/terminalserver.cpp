@@ -0,0 +1,122 @@
+/*
+  terminalserver.cpp - Terminal Server - A fixed pool of Terminal sessions for network clients
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#include "terminalserver.h"
+
+#ifdef TERMINAL_SERVER_SESSIONS
+namespace TerminalLibrary {
+void TerminalServerBase::setTerminalCommand(TerminalCommand* __terminalCommandPtr) {
+  for (unsigned int i = 0; i < TERMINAL_SERVER_SESSIONS; i++)
+    sessions[i].terminal->setTerminalCommand(__terminalCommandPtr);
+}
+
+void TerminalServerBase::setSessionBudget(unsigned int __sessionBudget) {
+  sessionBudget = __sessionBudget;
+  for (unsigned int i = 0; i < TERMINAL_SERVER_SESSIONS; i++) sessions[i].terminal->setInputBudget(sessionBudget);
+}
+
+// Binds a client to a free session, or restarts the session a reused client object still holds.
+// Returns nullptr when every session is in use.
+TerminalBase* TerminalServerBase::attach(Client* client) {
+  if (client == nullptr) return nullptr;
+  Session* session = nullptr;
+  for (unsigned int i = 0; i < TERMINAL_SERVER_SESSIONS; i++) {
+    if (sessions[i].client == client) {
+      session = &sessions[i];
+      reset(session); // The object now holds the new connection, which must not be stopped
+      break;
+    }
+  }
+  for (unsigned int i = 0; (session == nullptr) && (i < TERMINAL_SERVER_SESSIONS); i++) {
+    if (sessions[i].client == nullptr) session = &sessions[i];
+  }
+  if (session == nullptr) return nullptr;
+
+  TerminalBase* terminal = session->terminal;
+  terminal->configure(settings);
+  terminal->setBackpressure(backpressure);
+  terminal->setInputBudget(sessionBudget);
+  terminal->setStream(client);
+  terminal->setup();
+  session->client = client;
+  session->closing = false;
+  return terminal;
+}
+
+// Safe to call from a command running in the session, the session is torn down by the next poll.
+void TerminalServerBase::detach(OutputInterface* terminal) {
+  int session = findSession(terminal);
+  if (session >= 0) detach((unsigned int) session);
+}
+
+void TerminalServerBase::detach(unsigned int session) {
+  if ((session >= TERMINAL_SERVER_SESSIONS) || (sessions[session].client == nullptr)) return;
+  sessions[session].terminal->setStream(nullptr); // Flushes, and stops the input still in hand
+  sessions[session].closing = true;
+}
+
+// Returns the terminal of a session to its starting state, the client is left alone
+void TerminalServerBase::reset(Session* session) {
+  session->terminal->setStream(nullptr);
+#ifdef TERMINAL_TASKS
+  session->terminal->abortTask(); // Lets the task release its data, nothing is printed without a stream
+#endif
+  session->terminal->setup();
+#ifdef TERMINAL_STANDARD_COMMANDS_TERMINAL_HISTORY
+  session->terminal->clearHistory();
+#endif
+  for (unsigned int i = 0; i < MAX_CONTEXT; i++) session->terminal->setContext(i, nullptr);
+  session->closing = false;
+}
+
+void TerminalServerBase::release(Session* session) {
+  reset(session);
+  if (session->client != nullptr) session->client->stop();
+  session->client = nullptr;
+}
+
+// Services each connected session once, starting one further along each call so no session
+// is always first. Each session reads at most its budget, so one busy client cannot starve the rest.
+void TerminalServerBase::poll() {
+  unsigned int start = nextSession;
+  nextSession = (nextSession + 1) % TERMINAL_SERVER_SESSIONS;
+  for (unsigned int n = 0; n < TERMINAL_SERVER_SESSIONS; n++) {
+    Session* session = &sessions[(start + n) % TERMINAL_SERVER_SESSIONS];
+    if (session->client == nullptr) continue;
+    // A terminal that gave up on its client, BACKPRESSURE_DISCONNECT, has dropped the stream
+    if (session->closing || (session->terminal->getOutput() == nullptr) || !session->client->connected()) {
+      release(session);
+      continue;
+    }
+    session->terminal->loop();
+  }
+}
+
+TerminalBase* TerminalServerBase::getSession(unsigned int session) {
+  if ((session >= TERMINAL_SERVER_SESSIONS) || (sessions[session].client == nullptr)) return nullptr;
+  return sessions[session].terminal;
+}
+
+Client* TerminalServerBase::getClient(unsigned int session) {
+  if (session >= TERMINAL_SERVER_SESSIONS) return nullptr;
+  return sessions[session].client;
+}
+
+int TerminalServerBase::findSession(OutputInterface* terminal) {
+  for (unsigned int i = 0; i < TERMINAL_SERVER_SESSIONS; i++) {
+    if ((sessions[i].client != nullptr) && (sessions[i].terminal == terminal)) return (int) i;
+  }
+  return -1;
+}
+
+unsigned int TerminalServerBase::getSessionCount() {
+  unsigned int count = 0;
+  for (unsigned int i = 0; i < TERMINAL_SERVER_SESSIONS; i++) {
+    if (sessions[i].client != nullptr) count++;
+  }
+  return count;
+}
+} // namespace TerminalLibrary
+#endif
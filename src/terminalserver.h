@@ -0,0 +1,86 @@
+/*
+  terminalserver.h - Terminal Server - A fixed pool of Terminal sessions for network clients
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+#ifndef __TERMINAL_SERVER
+#define __TERMINAL_SERVER
+
+#include "features.h"
+
+#ifdef TERMINAL_SERVER_SESSIONS
+#include "terminalclass.h"
+
+#include <Client.h>
+
+namespace TerminalLibrary {
+
+// Every session is a full terminal with its own line, history, settings and contexts,
+// all of them share the same TerminalCommand registry (TERM_CMD unless changed).
+// The sessions are owned by BasicTerminalServer, so every size of session shares this code.
+class TerminalServerBase {
+public:
+  TerminalServerBase(const TerminalServerBase&) = delete;
+  TerminalServerBase& operator=(const TerminalServerBase&) = delete;
+  void configure(const TerminalSettings& __settings) { settings = __settings; };
+  void setTerminalCommand(TerminalCommand* __terminalCommandPtr);
+  void setSessionBudget(unsigned int __sessionBudget);
+  unsigned int getSessionBudget() { return sessionBudget; };
+  void setBackpressure(BACKPRESSURE_POLICY __backpressure) { backpressure = __backpressure; };
+  BACKPRESSURE_POLICY getBackpressure() { return backpressure; };
+  TerminalBase* attach(Client* client);
+  void detach(OutputInterface* terminal);
+  void detach(unsigned int session);
+  void poll();
+  TerminalBase* getSession(unsigned int session);
+  Client* getClient(unsigned int session);
+  int findSession(OutputInterface* terminal);
+  unsigned int getSessionCount();
+  unsigned int getMaxSessions() { return TERMINAL_SERVER_SESSIONS; };
+
+protected:
+  TerminalServerBase() {};
+  struct Session {
+    TerminalBase* terminal = nullptr;
+    Client* client = nullptr;
+    bool closing = false;
+  };
+  Session sessions[TERMINAL_SERVER_SESSIONS];
+
+private:
+  TerminalSettings settings; // Given to each session as it is attached
+  unsigned int sessionBudget = TERMINAL_INPUT_BUDGET;
+  // Never BACKPRESSURE_BLOCK by default, a congested client would hold up the serial console
+  BACKPRESSURE_POLICY backpressure = BACKPRESSURE_DROP;
+  unsigned int nextSession = 0;
+
+  void reset(Session* session);
+  void release(Session* session);
+};
+
+// A server whose sessions are BasicTerminal<LineLength, HistoryDepth, Features>, so a pool of
+// telnet sessions can be sized apart from the serial console.
+template <unsigned int LineLength = MAX_INPUT_LINE, unsigned int HistoryDepth = HISTORY_BUFFER,
+          unsigned int Features = TERMINAL_FEATURE_ALL>
+class BasicTerminalServer : public TerminalServerBase {
+public:
+  typedef BasicTerminal<LineLength, HistoryDepth, Features> SessionTerminal;
+  BasicTerminalServer() {
+    for (unsigned int i = 0; i < TERMINAL_SERVER_SESSIONS; i++) sessions[i].terminal = &terminals[i].terminal;
+  };
+  SessionTerminal* attach(Client* client) { return static_cast<SessionTerminal*>(TerminalServerBase::attach(client)); };
+  SessionTerminal* getSession(unsigned int session) {
+    return static_cast<SessionTerminal*>(TerminalServerBase::getSession(session));
+  };
+
+private:
+  struct Slot {
+    Slot() : terminal(nullptr) {};
+    SessionTerminal terminal;
+  };
+  Slot terminals[TERMINAL_SERVER_SESSIONS];
+};
+
+typedef BasicTerminalServer<> TerminalServer;
+} // namespace TerminalLibrary
+#endif
+#endif
@@ -0,0 +1,88 @@
+/*
+  termparam.cpp - Terminal Parameters - Typed parameter schema, parsed once for a command
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#include "termparam.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace TerminalLibrary {
+// Binary search of the sorted choices, -1 when text is not one of them
+static long findChoice(const char* const* choices, unsigned char count, const char* text) {
+  int low = 0;
+  int high = (int) count - 1;
+  while (low <= high) {
+    int middle = (low + high) / 2;
+    int compare = strcmp_P(text, (const char*) pgm_read_ptr(&choices[middle]));
+    if (compare == 0) return middle;
+    if (compare > 0)
+      low = middle + 1;
+    else
+      high = middle - 1;
+  }
+  return -1;
+}
+
+static bool inRange(const ParamSpec& spec, long value) {
+  return (spec.minimum > spec.maximum) || ((value >= spec.minimum) && (value <= spec.maximum));
+}
+
+static bool inRange(const ParamSpec& spec, float value) {
+  return (spec.minimumNumber > spec.maximumNumber) ||
+         ((value >= spec.minimumNumber) && (value <= spec.maximumNumber));
+}
+
+// Decimal, or hex after 0x. A leading 0 is still decimal, "010" is ten and not octal eight.
+static long parseInteger(const char* text, char** end) {
+  const char* digits = ((*text == '-') || (*text == '+')) ? text + 1 : text;
+  int base = ((digits[0] == '0') && ((digits[1] == 'x') || (digits[1] == 'X'))) ? 16 : 10;
+  return strtol(text, end, base);
+}
+
+static bool parseValue(const ParamSpec& spec, const char* text, ParamValue* value) {
+  char* end = nullptr;
+  value->present = true;
+  value->text = text;
+  switch (spec.type) {
+  case PARAM_INT:
+    value->integer = parseInteger(text, &end);
+    return (end != text) && (*end == '\0') && inRange(spec, value->integer);
+  case PARAM_FLOAT:
+    value->number = (float) strtod(text, &end);
+    return (end != text) && (*end == '\0') && inRange(spec, value->number);
+  case PARAM_ENUM: value->integer = findChoice(spec.choices, spec.choiceCount, text); return value->integer >= 0;
+  case PARAM_FLAG: value->integer = 1; return true;
+  default: return true;
+  }
+}
+
+bool parseParameters(const ParamSpec* specs, unsigned int count, ParamValue* values, char* const* argv,
+                     unsigned int argc) {
+  ParamSpec spec;
+  memset(values, 0, count * sizeof(ParamValue));
+  unsigned int next = 0; // The next positional spec
+  for (unsigned int i = 0; i < argc; i++) {
+    unsigned int s;
+    for (s = 0; s < count; s++) {
+      memcpy_P(&spec, &specs[s], sizeof(ParamSpec));
+      if ((spec.type == PARAM_FLAG) && (strcmp_P(argv[i], spec.name) == 0)) break;
+    }
+    if (s == count) {
+      for (s = next; s < count; s++) {
+        memcpy_P(&spec, &specs[s], sizeof(ParamSpec));
+        if (spec.type != PARAM_FLAG) break;
+      }
+      if (s == count) return false;
+      next = s + 1;
+    }
+    if (!parseValue(spec, argv[i], &values[s])) return false;
+  }
+  for (unsigned int s = 0; s < count; s++) {
+    memcpy_P(&spec, &specs[s], sizeof(ParamSpec));
+    if (spec.required && !values[s].present) return false;
+  }
+  return true;
+}
+} // namespace TerminalLibrary
@@ -0,0 +1,59 @@
+/*
+  termparam.h - Terminal Parameters - Typed parameter schema, parsed once for a command
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#ifndef __TERMINAL_PARAMETERS
+#define __TERMINAL_PARAMETERS
+
+#include <Arduino.h>
+
+namespace TerminalLibrary {
+typedef enum { PARAM_INT, PARAM_FLOAT, PARAM_ENUM, PARAM_FLAG, PARAM_STRING } PARAM_TYPES;
+
+// One parameter of a command. A flag is matched by its name anywhere on the line, the other
+// parameters take the remaining arguments in order. On AVR an array of these, its names and
+// its choices must be PROGMEM, elsewhere const is enough. Use the param... helpers to build one.
+struct ParamSpec {
+  PARAM_TYPES type;
+  const char* name;
+  bool required;
+  long minimum; // Range of PARAM_INT, none when minimum > maximum
+  long maximum;
+  float minimumNumber; // Range of PARAM_FLOAT, none when minimumNumber > maximumNumber
+  float maximumNumber;
+  const char* const* choices; // PARAM_ENUM, sorted, the value is the position of the match
+  unsigned char choiceCount;
+};
+
+// What was typed for one ParamSpec. text is the argument itself, or nullptr when not present.
+struct ParamValue {
+  bool present;
+  long integer; // PARAM_INT, the choice of PARAM_ENUM, 1 for a PARAM_FLAG
+  float number; // PARAM_FLOAT
+  const char* text;
+};
+
+constexpr ParamSpec paramInt(const char* name, long minimum, long maximum, bool required = true) {
+  return {PARAM_INT, name, required, minimum, maximum, 1, 0, nullptr, 0};
+}
+constexpr ParamSpec paramFloat(const char* name, float minimum = 1, float maximum = 0, bool required = true) {
+  return {PARAM_FLOAT, name, required, 1, 0, minimum, maximum, nullptr, 0};
+}
+constexpr ParamSpec paramEnum(const char* name, const char* const* choices, unsigned char count, bool required = true) {
+  return {PARAM_ENUM, name, required, 1, 0, 1, 0, choices, count};
+}
+constexpr ParamSpec paramFlag(const char* name) {
+  return {PARAM_FLAG, name, false, 1, 0, 1, 0, nullptr, 0};
+}
+constexpr ParamSpec paramString(const char* name, bool required = true) {
+  return {PARAM_STRING, name, required, 1, 0, 1, 0, nullptr, 0};
+}
+
+// Fills values[i] for specs[i] from argv. Returns false for an unknown choice, a number that
+// is not one or is out of range, a missing required parameter, or an argument left over.
+bool parseParameters(const ParamSpec* specs, unsigned int count, ParamValue* values, char* const* argv,
+                     unsigned int argc);
+} // namespace TerminalLibrary
+
+#endif
@@ -3,72 +3,190 @@
 #include <string.h>
 
 namespace TerminalUtility {
-CommandBuffer::CommandBuffer() {
+CommandBuffer::CommandBuffer(char* __buffer, unsigned long __size) : cmdBuffer(__buffer), capacity(__size - 1) {
   clearBuffer();
-  memset(blankLine, ' ', MAX_INPUT_LINE);
-  memset(tempLine, 0, MAX_INPUT_LINE);
-  blankLine[MAX_INPUT_LINE - 1] = 0;
 }
 
 void CommandBuffer::clearBuffer() {
-  memset(cmdBuffer, 0, MAX_INPUT_LINE);
-  cmdBufferIndex = 0;
+  gapStart = 0;
+  gapEnd = capacity;
+  length = 0;
+  cursor = 0;
+  cmdBuffer[0] = 0;
 }
 
-void CommandBuffer::setCommand(char* command) {
-  clearBuffer();
-  strncpy(cmdBuffer, command, MAX_INPUT_LINE - 1);
-  cmdBufferIndex = strnlen(cmdBuffer, MAX_INPUT_LINE);
+void CommandBuffer::setCommand(const char* command) {
+  setCommand(command, strnlen(command, capacity));
+}
+
+void CommandBuffer::setCommand(const char* command, unsigned long __length) {
+  if (__length > capacity) __length = capacity;
+  __length = strnlen(command, __length);
+  memmove(cmdBuffer, command, __length);
+  gapStart = __length;
+  gapEnd = capacity;
+  length = __length;
+  cursor = __length;
 }
 
 char* CommandBuffer::getCommand() {
+  unsigned long tail = capacity - gapEnd;
+  if (tail > 0) {
+    memmove(&cmdBuffer[gapStart], &cmdBuffer[gapEnd], tail);
+    gapStart += tail;
+    gapEnd = capacity;
+  }
+  cmdBuffer[length] = 0;
   return cmdBuffer;
 }
 
-unsigned long CommandBuffer::getCommandLength() {
-  return strnlen(cmdBuffer, MAX_INPUT_LINE);
+char CommandBuffer::characterAt(unsigned long index) {
+  return (index < gapStart) ? cmdBuffer[index] : cmdBuffer[index + (gapEnd - gapStart)];
 }
 
-bool CommandBuffer::addCharacter(char character) {
-  bool added = false;
-  if (cmdBufferIndex < MAX_INPUT_LINE - 1) {
-    memset(tempLine, 0, MAX_INPUT_LINE);
-    memcpy(tempLine, &cmdBuffer[cmdBufferIndex], MAX_INPUT_LINE - cmdBufferIndex);
-    cmdBuffer[cmdBufferIndex] = character;
-    memcpy(&cmdBuffer[cmdBufferIndex + 1], tempLine, MAX_INPUT_LINE - cmdBufferIndex);
-    cmdBuffer[MAX_INPUT_LINE - 1] = 0;
-    cmdBufferIndex++;
-    added = true;
+// Where index is stored. count is cut to the characters that follow it in memory, the gap
+// splits the line in at most two such runs.
+const char* CommandBuffer::span(unsigned long index, unsigned long* count) {
+  unsigned long stored = (index < gapStart) ? index : index + (gapEnd - gapStart);
+  unsigned long run = (index < gapStart) ? gapStart - index : capacity - stored;
+  if (*count > run) *count = run;
+  return &cmdBuffer[stored];
+}
+
+void CommandBuffer::copy(unsigned long index, unsigned long count, char* out) {
+  while (count > 0) {
+    unsigned long part = count;
+    const char* text = span(index, &part);
+    memcpy(out, text, part);
+    out += part;
+    index += part;
+    count -= part;
   }
-  return added;
 }
 
-bool CommandBuffer::deleteCharacter() {
-  bool deleted = false;
-  if (cmdBufferIndex > 0) {
-    memset(tempLine, 0, MAX_INPUT_LINE);
-    memcpy(tempLine, &cmdBuffer[cmdBufferIndex], MAX_INPUT_LINE - cmdBufferIndex);
-    memcpy(&cmdBuffer[cmdBufferIndex - 1], tempLine, MAX_INPUT_LINE - cmdBufferIndex);
-    cmdBuffer[MAX_INPUT_LINE - 1] = 0;
-    cmdBufferIndex--;
-    deleted = true;
+// Brings the gap to the cursor, only the characters between the two are moved.
+void CommandBuffer::moveGap() {
+  if (cursor < gapStart) {
+    unsigned long count = gapStart - cursor;
+    memmove(&cmdBuffer[gapEnd - count], &cmdBuffer[cursor], count);
+    gapStart -= count;
+    gapEnd -= count;
+  } else if (cursor > gapStart) {
+    unsigned long count = cursor - gapStart;
+    memmove(&cmdBuffer[gapStart], &cmdBuffer[gapEnd], count);
+    gapStart += count;
+    gapEnd += count;
   }
-  return deleted;
+}
+
+bool CommandBuffer::addCharacter(char character) {
+  if (length >= capacity) return false;
+  moveGap();
+  cmdBuffer[gapStart++] = character;
+  cursor++;
+  length++;
+  return true;
+}
+
+bool CommandBuffer::deleteCharacter() {
+  if (cursor == 0) return false;
+  moveGap();
+  gapStart--;
+  cursor--;
+  length--;
+  return true;
+}
+
+bool CommandBuffer::deleteForward() {
+  if (cursor >= length) return false;
+  moveGap();
+  gapEnd++;
+  length--;
+  return true;
+}
+
+bool CommandBuffer::deleteWord() {
+  unsigned long start = previousWord();
+  if (start == cursor) return false;
+  moveGap();
+  length -= cursor - start;
+  gapStart = start;
+  cursor = start;
+  return true;
+}
+
+bool CommandBuffer::killToEnd() {
+  if (cursor >= length) return false;
+  moveGap();
+  length -= capacity - gapEnd;
+  gapEnd = capacity;
+  return true;
+}
+
+bool CommandBuffer::killToStart() {
+  if (cursor == 0) return false;
+  moveGap();
+  length -= gapStart;
+  gapStart = 0;
+  cursor = 0;
+  return true;
 }
 
 bool CommandBuffer::backIndex() {
-  if (cmdBufferIndex > 0) {
-    cmdBufferIndex--;
+  if (cursor > 0) {
+    cursor--;
     return true;
   }
   return false;
 }
 
 bool CommandBuffer::forwardIndex() {
-  if (cmdBufferIndex < getCommandLength()) {
-    cmdBufferIndex++;
+  if (cursor < length) {
+    cursor++;
     return true;
   }
   return false;
 }
-} // namespace TerminalUtility
\ No newline at end of file
+
+// Start of the word before the cursor, skipping the spaces in between.
+unsigned long CommandBuffer::previousWord() {
+  unsigned long index = cursor;
+  while (index > 0 && characterAt(index - 1) == ' ') index--;
+  while (index > 0 && characterAt(index - 1) != ' ') index--;
+  return index;
+}
+
+// End of the word after the cursor, skipping the spaces in between.
+unsigned long CommandBuffer::nextWord() {
+  unsigned long index = cursor;
+  while (index < length && characterAt(index) == ' ') index++;
+  while (index < length && characterAt(index) != ' ') index++;
+  return index;
+}
+
+bool CommandBuffer::wordLeft() {
+  unsigned long index = previousWord();
+  if (index == cursor) return false;
+  cursor = index;
+  return true;
+}
+
+bool CommandBuffer::wordRight() {
+  unsigned long index = nextWord();
+  if (index == cursor) return false;
+  cursor = index;
+  return true;
+}
+
+bool CommandBuffer::home() {
+  if (cursor == 0) return false;
+  cursor = 0;
+  return true;
+}
+
+bool CommandBuffer::end() {
+  if (cursor == length) return false;
+  cursor = length;
+  return true;
+}
+} // namespace TerminalUtility
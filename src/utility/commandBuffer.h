@@ -1,29 +1,49 @@
 #ifndef __TERMINAL_COMMAND_BUFFER
 #define __TERMINAL_COMMAND_BUFFER
 
-#include "../features.h"
-
 namespace TerminalUtility {
+// The line is kept as a gap buffer: text before the gap, free space, text after the gap.
+// The gap follows the cursor lazily, so typing or deleting at the cursor does not move
+// the rest of the line. getCommand() closes the gap to hand out a NUL terminated string, it is
+// for a submitted line, echo reads the line in place with characterAt, span and copy.
+// The memory belongs to the owner, size includes the byte kept for the NUL.
 class CommandBuffer {
 public:
-  CommandBuffer();
+  CommandBuffer(char* __buffer, unsigned long __size);
   void clearBuffer();
-  void setCommand(char* command);
+  void setCommand(const char* command);
+  void setCommand(const char* command, unsigned long length);
   char* getCommand();
-  char* getBlank();
-  unsigned long getCommandLength();
+  unsigned long getCommandLength() { return length; };
   bool addCharacter(char character);
   bool deleteCharacter();
+  bool deleteForward();
+  bool deleteWord();
+  bool killToEnd();
+  bool killToStart();
   bool backIndex();
   bool forwardIndex();
-  unsigned long getIndex() { return cmdBufferIndex; };
+  bool wordLeft();
+  bool wordRight();
+  bool home();
+  bool end();
+  unsigned long getIndex() { return cursor; };
+  char characterAt(unsigned long index);
+  const char* span(unsigned long index, unsigned long* count);
+  void copy(unsigned long index, unsigned long count, char* out);
 
 private:
-  char cmdBuffer[MAX_INPUT_LINE];
-  char blankLine[MAX_INPUT_LINE];
-  char tempLine[MAX_INPUT_LINE];
-  unsigned long cmdBufferIndex = 0;
+  char* cmdBuffer;
+  unsigned long capacity;
+  unsigned long gapStart = 0;
+  unsigned long gapEnd = 0;
+  unsigned long length = 0;
+  unsigned long cursor = 0;
+
+  void moveGap();
+  unsigned long previousWord();
+  unsigned long nextWord();
 };
 } // namespace TerminalUtility
 
-#endif
\ No newline at end of file
+#endif
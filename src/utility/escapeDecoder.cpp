@@ -0,0 +1,122 @@
+/*
+  escapeDecoder.cpp - Utility Library - Resumable decoder for VT100/xterm key sequences
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#include "escapeDecoder.h"
+
+namespace TerminalUtility {
+static bool isControl(char character) {
+  return ((unsigned char) character < 0x20) || (character == 0x7F);
+}
+
+void EscapeDecoder::reset() {
+  state = GROUND;
+  parameter[0] = 0;
+  parameter[1] = 0;
+  parameterCount = 0;
+}
+
+ESCAPE_KEY EscapeDecoder::decode(char character, unsigned long now) {
+  lastByte = now;
+  switch (state) {
+  case GROUND:
+    if (character == 0x1B) {
+      reset();
+      state = ESCAPE;
+    }
+    return KEY_NONE;
+  case ESCAPE:
+    if (character == '[') {
+      state = CSI;
+      return KEY_NONE;
+    }
+    if (character == 'O') {
+      state = SS3;
+      return KEY_NONE;
+    }
+    if (character == 0x1B) return KEY_ESCAPE; // The first ESC was lone, the second starts again
+    reset();
+    if (isControl(character)) return KEY_REPROCESS;
+    if (character == 'f') return KEY_WORD_RIGHT;
+    if (character == 'b') return KEY_WORD_LEFT;
+    return KEY_UNKNOWN;
+  case CSI:
+    if (character >= '0' && character <= '9') {
+      if (parameterCount == 0) parameterCount = 1;
+      unsigned int* value = &parameter[parameterCount - 1];
+      if (*value < 1000) *value = *value * 10 + (character - '0');
+      return KEY_NONE;
+    }
+    if (character == ';') {
+      if (parameterCount == 0) parameterCount = 1;
+      if (parameterCount < MAX_PARAMETERS) parameterCount++;
+      return KEY_NONE;
+    }
+    if (character >= 0x20 && character <= 0x3F) return KEY_NONE; // Private markers and intermediates
+    if (character >= 0x40 && character <= 0x7E) {
+      ESCAPE_KEY key = csiFinal(character);
+      reset();
+      return key;
+    }
+    reset(); // A control character, such as Enter or Ctrl-C, aborts the sequence and is kept
+    return KEY_REPROCESS;
+  case SS3: {
+    if (isControl(character)) {
+      reset();
+      return KEY_REPROCESS;
+    }
+    ESCAPE_KEY key = ss3Final(character);
+    reset();
+    return key;
+  }
+  }
+  return KEY_NONE;
+}
+
+// Called when no byte arrived, resolves a lone ESC or drops a stalled sequence.
+ESCAPE_KEY EscapeDecoder::poll(unsigned long now) {
+  if ((state == GROUND) || ((now - lastByte) < timeout)) return KEY_NONE;
+  ESCAPE_KEY key = (state == ESCAPE) ? KEY_ESCAPE : KEY_UNKNOWN;
+  reset();
+  return key;
+}
+
+ESCAPE_KEY EscapeDecoder::csiFinal(char final) {
+  // xterm modifier parameter is 1 + (Shift 1, Alt 2, Ctrl 4)
+  bool wordMove = (parameterCount > 1) && (parameter[1] > 1) && (((parameter[1] - 1) & 0x6) != 0);
+  switch (final) {
+  case 'A': return KEY_UP;
+  case 'B': return KEY_DOWN;
+  case 'C': return wordMove ? KEY_WORD_RIGHT : KEY_RIGHT;
+  case 'D': return wordMove ? KEY_WORD_LEFT : KEY_LEFT;
+  case 'H': return KEY_HOME;
+  case 'F': return KEY_END;
+  case '~':
+    switch (parameter[0]) {
+    case 1:
+    case 7: return KEY_HOME;
+    case 2: return KEY_INSERT;
+    case 3: return KEY_DELETE;
+    case 4:
+    case 8: return KEY_END;
+    case 5: return KEY_PAGE_UP;
+    case 6: return KEY_PAGE_DOWN;
+    default: return KEY_UNKNOWN;
+    }
+  default: return KEY_UNKNOWN;
+  }
+}
+
+ESCAPE_KEY EscapeDecoder::ss3Final(char final) {
+  switch (final) {
+  case 'A': return KEY_UP;
+  case 'B': return KEY_DOWN;
+  case 'C': return KEY_RIGHT;
+  case 'D': return KEY_LEFT;
+  case 'H': return KEY_HOME;
+  case 'F': return KEY_END;
+  default: return KEY_UNKNOWN;
+  }
+}
+} // namespace TerminalUtility
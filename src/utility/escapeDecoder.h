@@ -0,0 +1,57 @@
+/*
+  escapeDecoder.h - Utility Library - Resumable decoder for VT100/xterm key sequences
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#ifndef __ESCAPE_DECODER
+#define __ESCAPE_DECODER
+
+#include "../features.h"
+
+namespace TerminalUtility {
+typedef enum {
+  KEY_NONE, // Sequence not complete yet
+  KEY_UP,
+  KEY_DOWN,
+  KEY_RIGHT,
+  KEY_LEFT,
+  KEY_HOME,
+  KEY_END,
+  KEY_INSERT,
+  KEY_DELETE,
+  KEY_PAGE_UP,
+  KEY_PAGE_DOWN,
+  KEY_WORD_RIGHT, // Ctrl or Alt + right arrow, Alt+f
+  KEY_WORD_LEFT,  // Ctrl or Alt + left arrow, Alt+b
+  KEY_ESCAPE,     // A lone ESC that nothing followed within the timeout
+  KEY_UNKNOWN,    // A complete sequence that is not mapped
+  KEY_REPROCESS   // A control character cut the sequence short, it is not part of it and is to be fed again
+} ESCAPE_KEY;
+
+// Bytes are fed one at a time and the partial sequence is kept between calls, so a
+// sequence split across reads, or loop calls, never has to be waited for.
+class EscapeDecoder {
+public:
+  void reset();
+  bool active() { return state != GROUND; };
+  ESCAPE_KEY decode(char character, unsigned long now);
+  ESCAPE_KEY poll(unsigned long now);
+  void setTimeout(unsigned long __timeout) { timeout = __timeout; };
+  unsigned long getTimeout() { return timeout; };
+
+private:
+  typedef enum { GROUND, ESCAPE, CSI, SS3 } DECODER_STATE;
+  static const unsigned char MAX_PARAMETERS = 2;
+
+  DECODER_STATE state = GROUND;
+  unsigned int parameter[MAX_PARAMETERS] = {0, 0};
+  unsigned char parameterCount = 0;
+  unsigned long lastByte = 0;
+  unsigned long timeout = TERMINAL_ESCAPE_TIMEOUT;
+
+  ESCAPE_KEY csiFinal(char final);
+  ESCAPE_KEY ss3Final(char final);
+};
+} // namespace TerminalUtility
+
+#endif
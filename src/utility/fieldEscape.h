@@ -0,0 +1,49 @@
+/*
+  fieldEscape.h - Utility Library - Escapes for quoted CSV fields and JSON strings
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#ifndef __FIELD_ESCAPE
+#define __FIELD_ESCAPE
+
+namespace TerminalUtility {
+// Writes c the way it must appear inside a quoted JSON string, or a quoted CSV field, to out
+// (room for 6) and returns the length. Characters that need no escape are written as they are.
+inline unsigned int escapeCharacter(char c, bool json, char* out) {
+  static const char hex[] = "0123456789abcdef";
+  out[0] = c;
+  if (!json) {
+    if (c != '"') return 1;
+    out[1] = '"';
+    return 2;
+  }
+  out[0] = '\\';
+  switch (c) {
+  case '"':
+  case '\\': out[1] = c; return 2;
+  case '\n': out[1] = 'n'; return 2;
+  case '\r': out[1] = 'r'; return 2;
+  case '\t': out[1] = 't'; return 2;
+  default: break;
+  }
+  if ((unsigned char) c >= 0x20) {
+    out[0] = c;
+    return 1;
+  }
+  out[1] = 'u';
+  out[2] = '0';
+  out[3] = '0';
+  out[4] = hex[(c >> 4) & 0x0F];
+  out[5] = hex[c & 0x0F];
+  return 6;
+}
+
+// Whether a CSV field must be quoted
+inline bool csvNeedsQuotes(const char* text, unsigned long length) {
+  for (unsigned long i = 0; i < length; i++)
+    if ((text[i] == ',') || (text[i] == '"') || (text[i] == '\r') || (text[i] == '\n')) return true;
+  return false;
+}
+} // namespace TerminalUtility
+
+#endif
@@ -0,0 +1,72 @@
+/*
+  hexDump.cpp - Utility Library - Table driven hex dump, one row at a time
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#include "hexDump.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+namespace TerminalUtility {
+static const char hexDigits[] = "0123456789abcdef";
+
+HexDump::HexDump(const unsigned char* __buffer, unsigned long __length, unsigned int __options,
+                 unsigned long __address) {
+  buffer = __buffer;
+  length = (__buffer == nullptr) ? 0 : __length;
+  options = __options;
+  address = __address;
+}
+
+unsigned int HexDump::encode(char* row, const unsigned char* bytes, unsigned int count) {
+  char* out = row;
+  unsigned long at = address + offset;
+  for (int shift = 28; shift >= 0; shift -= 4) *out++ = hexDigits[(at >> shift) & 0x0F];
+  *out++ = ':';
+  *out++ = ' ';
+  for (unsigned int i = 0; i < count; i++) {
+    *out++ = hexDigits[bytes[i] >> 4];
+    *out++ = hexDigits[bytes[i] & 0x0F];
+    *out++ = ' ';
+  }
+  if (options & HEXDUMP_ASCII) {
+    // Short last row, keep the gutter lined up with the rows above
+    unsigned int pad = 3 * (HEXDUMP_ROW_BYTES - count);
+    memset(out, ' ', pad);
+    out += pad;
+    *out++ = '|';
+    for (unsigned int i = 0; i < count; i++) *out++ = ((bytes[i] >= 0x20) && (bytes[i] < 0x7F)) ? bytes[i] : '.';
+    *out++ = '|';
+  }
+  *out = '\0';
+  return out - row;
+}
+
+unsigned int HexDump::next(char* row) {
+  unsigned char bytes[HEXDUMP_ROW_BYTES];
+  while (offset < length) {
+    unsigned long remaining = length - offset;
+    unsigned int count = (remaining < HEXDUMP_ROW_BYTES) ? remaining : HEXDUMP_ROW_BYTES;
+    if (options & HEXDUMP_PROGMEM)
+      memcpy_P(bytes, buffer + offset, count);
+    else
+      memcpy(bytes, buffer + offset, count);
+    if ((options & HEXDUMP_SQUEEZE) && (offset > 0) && (remaining > HEXDUMP_ROW_BYTES) &&
+        (memcmp(bytes, previous, HEXDUMP_ROW_BYTES) == 0)) {
+      offset += count;
+      if (squeezed) continue;
+      squeezed = true;
+      row[0] = '*';
+      row[1] = '\0';
+      return 1;
+    }
+    squeezed = false;
+    unsigned int rowLength = encode(row, bytes, count);
+    memcpy(previous, bytes, count);
+    offset += count;
+    return rowLength;
+  }
+  return 0;
+}
+} // namespace TerminalUtility
@@ -0,0 +1,43 @@
+/*
+  hexDump.h - Utility Library - Table driven hex dump, one row at a time
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#ifndef __HEX_DUMP
+#define __HEX_DUMP
+
+#define HEXDUMP_ROW_BYTES 16
+#define HEXDUMP_ROW_SIZE (10 + 3 * HEXDUMP_ROW_BYTES + 1 + HEXDUMP_ROW_BYTES + 2) // Address, bytes, gutter, '\0'
+
+namespace TerminalUtility {
+typedef enum {
+  HEXDUMP_PLAIN = 0,   // "00000010: 30 31 32 ... "
+  HEXDUMP_ASCII = 1,   // Adds the printable characters, "|0123456789abcdef|"
+  HEXDUMP_SQUEEZE = 2, // Rows that repeat the one before are printed as a single "*"
+  HEXDUMP_PROGMEM = 4  // The buffer is in flash, on AVR
+} HEXDUMP_OPTIONS;
+
+// Each call to next writes the following row into the caller's buffer of HEXDUMP_ROW_SIZE, so any
+// length is dumped in constant memory and several dumps can be running at once. The last row is
+// never squeezed, so the end of the buffer always shows.
+class HexDump {
+public:
+  HexDump(const unsigned char* __buffer, unsigned long __length, unsigned int __options = HEXDUMP_PLAIN,
+          unsigned long __address = 0);
+  unsigned int next(char* row); // Returns the length of the row, 0 when done
+  bool done() { return offset >= length; };
+
+private:
+  const unsigned char* buffer;
+  unsigned long length;
+  unsigned long offset = 0;
+  unsigned long address; // Printed for the first byte
+  unsigned int options;
+  bool squeezed = false; // The "*" for the current run of repeats was printed
+  unsigned char previous[HEXDUMP_ROW_BYTES];
+
+  unsigned int encode(char* row, const unsigned char* bytes, unsigned int count);
+};
+} // namespace TerminalUtility
+
+#endif
@@ -0,0 +1,101 @@
+/*
+  history.cpp - Utility Library - Command history packed into one byte arena
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#include "history.h"
+
+#include <string.h>
+
+namespace TerminalUtility {
+static const unsigned long MAX_ENTRY = 255; // Longest entry the length byte can describe
+static const unsigned long OVERHEAD = 2;    // Length byte and NUL
+
+History::History(char* __memory, unsigned long __capacity) {
+  memory = (unsigned char*) __memory;
+  arenaSize = (memory == nullptr) ? 0 : __capacity;
+  clear();
+}
+
+// Entries longer than the arena, or than MAX_ENTRY, keep their beginning.
+bool History::push(const char* entry, unsigned long length) {
+  if ((entry == nullptr) || (length == 0) || (arenaSize <= OVERHEAD)) return false;
+  if (length > MAX_ENTRY) length = MAX_ENTRY;
+  if (length > arenaSize - OVERHEAD) length = arenaSize - OVERHEAD;
+  if (skipDuplicates && !empty() && (memory[last] == length) && (memcmp(entryAt(last), entry, length) == 0))
+    return true;
+
+  unsigned long needed = length + OVERHEAD;
+  unsigned long position;
+  while (true) {
+    if (empty()) {
+      position = 0;
+      break;
+    }
+    if (next > first) {
+      // Live entries sit in [first, next), room is at the end and before first
+      if (arenaSize - next >= needed) {
+        position = next;
+        break;
+      }
+      if (first >= needed) {
+        if (next < arenaSize) memory[next] = 0;
+        position = 0;
+        break;
+      }
+    } else if (first - next >= needed) {
+      // Live entries wrap, room is only in [next, first)
+      position = next;
+      break;
+    }
+    evict();
+  }
+
+  memory[position] = (unsigned char) length;
+  memcpy(&memory[position + 1], entry, length);
+  memory[position + 1 + length] = 0;
+  last = position;
+  next = position + needed;
+  count++;
+  return true;
+}
+
+const char* History::get(unsigned long index) {
+  if (index >= count) return nullptr;
+  return entryAt(find(index));
+}
+
+unsigned long History::length(unsigned long index) {
+  if (index >= count) return 0;
+  return memory[find(index)];
+}
+
+void History::clear() {
+  first = 0;
+  next = 0;
+  last = 0;
+  count = 0;
+}
+
+// Offset of the entry after the one at position, following the wrap to the beginning
+unsigned long History::following(unsigned long position) {
+  position += memory[position] + OVERHEAD;
+  if ((position >= arenaSize) || (memory[position] == 0)) position = 0;
+  return position;
+}
+
+unsigned long History::find(unsigned long index) {
+  if (index == count - 1) return last;
+  unsigned long position = first;
+  while (index-- > 0) position = following(position);
+  return position;
+}
+
+void History::evict() {
+  count--;
+  if (count == 0)
+    clear();
+  else
+    first = following(first);
+}
+} // namespace TerminalUtility
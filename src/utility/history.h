@@ -0,0 +1,46 @@
+/*
+  history.h - Utility Library - Command history packed into one byte arena
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#ifndef __HISTORY
+#define __HISTORY
+
+namespace TerminalUtility {
+// Each entry is stored as a length byte, the characters and a NUL, one after the other in
+// a ring of bytes. An entry never wraps: when it does not fit before the end of the arena a
+// zero length byte marks the end and it starts again at the beginning. The oldest entries
+// are evicted to make room, so short commands take only the room they need.
+class History {
+public:
+  History(char* __memory, unsigned long __capacity);
+  History(const History&) = delete;
+  History& operator=(const History&) = delete;
+  bool push(const char* entry, unsigned long length);
+  const char* get(unsigned long index); // 0 is the oldest entry, nullptr when out of range
+  unsigned long length(unsigned long index);
+  const char* newest() { return empty() ? nullptr : entryAt(last); };
+  unsigned long size() { return count; };
+  bool empty() { return count == 0; };
+  unsigned long capacity() { return arenaSize; };
+  void clear();
+  void setSkipDuplicates(bool __skipDuplicates) { skipDuplicates = __skipDuplicates; };
+  bool getSkipDuplicates() { return skipDuplicates; };
+
+private:
+  unsigned char* memory;
+  unsigned long arenaSize;
+  unsigned long first = 0; // Offset of the oldest entry
+  unsigned long next = 0;  // Offset the next entry is written to
+  unsigned long last = 0;  // Offset of the newest entry
+  unsigned long count = 0;
+  bool skipDuplicates = true;
+
+  const char* entryAt(unsigned long position) { return (const char*) &memory[position + 1]; };
+  unsigned long following(unsigned long position);
+  unsigned long find(unsigned long index);
+  void evict();
+};
+} // namespace TerminalUtility
+
+#endif
@@ -0,0 +1,83 @@
+/*
+  ring.h - Utility Library - Typed power of two ring buffer
+  Copyright (c) 2025 John J. Gavel.  All right reserved.
+*/
+
+#ifndef __RING
+#define __RING
+
+#ifdef ARDUINO_ARCH_AVR
+#include <new.h>
+#else
+#include <new>
+#endif
+#include <stddef.h>
+
+namespace TerminalUtility {
+// head and tail run freely and are masked on use, so no division is done and a full ring
+// needs no spare slot. Elements are constructed in place on push and destroyed on pop.
+template <typename T, unsigned int N> class Ring {
+  static_assert((N > 0) && ((N & (N - 1)) == 0), "Ring size must be a power of two");
+
+public:
+  Ring() {};
+  ~Ring() { clear(); };
+  Ring(const Ring&) = delete;
+  Ring& operator=(const Ring&) = delete;
+  bool full() { return size() == N; };
+  bool empty() { return head == tail; };
+  unsigned int size() { return head - tail; };
+  unsigned int capacity() { return N; };
+  bool push(const T& element) { return emplace(element); };
+  template <typename... Args> bool emplace(Args&&... args) {
+    if (full()) return false;
+    new (slot(head)) T(static_cast<Args&&>(args)...);
+    head++;
+    return true;
+  };
+  bool pop(T* element = nullptr) {
+    if (empty()) return false;
+    T* front = slot(tail);
+    if (element != nullptr) *element = static_cast<T&&>(*front);
+    front->~T();
+    tail++;
+    return true;
+  };
+  // index 0 is the oldest element
+  T* get(unsigned int index) { return (index < size()) ? slot(tail + index) : nullptr; };
+  T* front() { return get(0); };
+  T* back() { return empty() ? nullptr : slot(head - 1); };
+  void clear() {
+    while (pop()) {}
+  };
+  // Bulk versions for byte streams. push copies in what there is room for and returns how much,
+  // span is the oldest run that is contiguous in memory, ready for one write, and drop removes
+  // count of the oldest.
+  unsigned int push(const T* elements, unsigned int count) {
+    unsigned int room = N - size();
+    if (count > room) count = room;
+    for (unsigned int i = 0; i < count; i++) new (slot(head + i)) T(elements[i]);
+    head += count;
+    return count;
+  };
+  T* span(unsigned int* count) {
+    unsigned int end = N - (tail & (N - 1));
+    *count = (size() < end) ? size() : end;
+    return slot(tail);
+  };
+  void drop(unsigned int count) {
+    if (count > size()) count = size();
+    for (unsigned int i = 0; i < count; i++) slot(tail + i)->~T();
+    tail += count;
+  };
+
+private:
+  alignas(T) unsigned char memory[N * sizeof(T)];
+  unsigned int head = 0;
+  unsigned int tail = 0;
+
+  T* slot(unsigned int index) { return reinterpret_cast<T*>(&memory[(index & (N - 1)) * sizeof(T)]); };
+};
+} // namespace TerminalUtility
+
+#endif